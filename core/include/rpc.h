@@ -11,19 +11,114 @@
 
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include "rpc_types.h"
 #include "rpc_errors.h"
 #include "rpc_osal.h"
 
 
+/**
+ * @brief RPC initialization options.
+ */
+typedef struct {
+    /**
+     * Runtime model. RPC_RUNTIME_REACTOR runs PHY reads, frame parsing,
+     * handlers and writes on a single event loop thread, so handlers must
+     * not block and must not issue rpc_request() themselves.
+     */
+    rpc_runtime_t runtime;
+
+    /**
+     * Place every OSAL object (queues, semaphores, mutexes, threads,
+     * timers) in one arena sized from rpc_config.h, allocated and
+     * prefaulted at init; nothing is allocated after rpc_start().
+     */
+    bool arena;
+
+    /** OS_ARENA_HUGEPAGES / OS_ARENA_MLOCK, used with @c arena */
+    uint32_t arena_flags;
+
+    /**
+     * Run incoming stream handlers from rpc_poll() in the application's
+     * thread instead of the workers (or the reactor loop).
+     */
+    bool poll_streams;
+
+    /**
+     * How rpc_request() waits for its response. RPC_WAIT_ADAPTIVE spins
+     * for about the method's smoothed round trip (learned from earlier
+     * responses, at most @c wait_spin_max_us) before sleeping, which saves
+     * the wakeup latency of fast calls at the cost of CPU time.
+     * RPC_WAIT_DEFAULT selects RPC_WAIT_MODE_DEFAULT (RPC_WAIT_PARK).
+     */
+    rpc_wait_t wait;
+
+    /** Longest adaptive spin in microseconds, 0 for RPC_WAIT_SPIN_MAX_US */
+    uint32_t wait_spin_max_us;
+
+    /**
+     * Method table shared with the peer (static), NULL to send names.
+     * Messages for these methods carry a 16-bit ID instead of the name,
+     * and incoming ones are dispatched by array index. Both peers must
+     * use the same table; methods not in it still go by name.
+     */
+    const rpc_method_t* methods;
+
+    /** Number of entries in @c methods */
+    size_t method_count;
+
+    /**
+     * Where rpc_request_async() callbacks run. A NULL @c submit delivers
+     * them from rpc_poll(); rpc_exec_inline runs them right in the thread
+     * that resolved the request (transport or timer thread, reactor
+     * loop), so they must then be short and must not block; any other
+     * submit function hands them to the application's own thread pool.
+     */
+    rpc_executor_t executor;
+
+    /**
+     * Dispatch classes 1..@c class_count (class 0 is the default class,
+     * RPC_WORKER_COUNT workers). Each has its own request queue and
+     * workers, so methods registered to it with rpc_register_ex() neither
+     * wait behind nor hold up the methods of other classes. Ignored by
+     * the reactor runtime, whose loop runs every handler.
+     */
+    const rpc_class_cfg_t* classes;
+
+    /** Number of entries in @c classes, at most RPC_CLASS_MAX - 1 */
+    size_t class_count;
+
+    /**
+     * How the workers of a class share its requests. RPC_SCHED_STEAL
+     * gives every worker a deque of its own, filled by the transport
+     * thread (an idle worker first, otherwise round robin); a worker whose
+     * deque is empty steals from the others' before sleeping, so the
+     * workers no longer contend on one queue. RPC_SCHED_DEFAULT selects
+     * RPC_SCHED_MODE_DEFAULT.
+     */
+    rpc_sched_t sched;
+} rpc_init_cfg_t;
+
+
 /**
  * @brief Initialize the RPC system.
  *
- * Must be called before any other RPC functions.
+ * Must be called before any other RPC functions. Uses the runtime
+ * selected by RPC_RUNTIME_DEFAULT in rpc_config.h.
  */
 int rpc_init(void);
 
 
+/**
+ * @brief Initialize the RPC system with explicit options.
+ *
+ * @param cfg Options, NULL for the defaults used by rpc_init().
+ * @return RPC_SUCCESS on success, RPC_ERROR on failure.
+ */
+int rpc_init_ex(const rpc_init_cfg_t* cfg);
+
+
 /**
  * @brief Start RPC tasks/threads.
  *
@@ -35,19 +130,39 @@ void rpc_start(void);
 /**
  * @brief Register a function to be callable remotely.
  *
+ * Any number of functions may be registered, also while requests are
+ * served; a name registered twice keeps its first handler.
+ *
  * @param name   Null-terminated function name (must not be empty).
  * @param fn     Pointer to handler function.
  *
- * @return RPC_SUCCESS on success, RPC_ERROR on failure.
+ * @return RPC_SUCCESS on success, or an error code (<0).
  */
 int  rpc_register(const char* name, rpc_fn_t fn);
 
 
+/**
+ * @brief Register a function served by the workers of a dispatch class.
+ *
+ * As rpc_register() (which uses class 0); requests for the function go
+ * to the queue of @p dispatch_class.
+ *
+ * @param name   Null-terminated function name (must not be empty).
+ * @param fn     Pointer to handler function.
+ * @param dispatch_class Class index, below 1 + rpc_init_cfg_t::class_count.
+ *
+ * @return RPC_SUCCESS on success, or an error code (<0).
+ */
+int  rpc_register_ex(const char* name, rpc_fn_t fn, uint8_t dispatch_class);
+
+
 /**
  * @brief Perform a remote procedure call (synchronous).
  *
  * Sends a request message, waits for a response, and copies
- * the result into the provided response buffer.
+ * the result into the provided response buffer. With all request slots
+ * in flight, callers queue for one in arrival order; the time queued
+ * counts against @p timeout_ms.
  *
  * @param name      Null-terminated function name to call.
  * @param args      Pointer to arguments buffer (may be NULL if no args).
@@ -62,6 +177,192 @@ int rpc_request(const char* name, const void* args, uint16_t args_len,
 			    void* resp_buf, uint16_t* resp_len, uint32_t timeout_ms);
 
 
+/**
+ * @brief Perform a synchronous remote procedure call with per-call options.
+ *
+ * As rpc_request(), with the response wait strategy of this call
+ * overridden by @p opts.
+ *
+ * @param name      Null-terminated function name to call.
+ * @param args      Pointer to arguments buffer (may be NULL if no args).
+ * @param args_len  Length of arguments.
+ * @param resp_buf  Buffer to receive response data.
+ * @param resp_len  In: capacity of @p resp_buf. Out: actual response length.
+ * @param timeout_ms Timeout to wait for response (ms).
+ * @param opts      Call options, NULL for the defaults.
+ *
+ * @return RPC_SUCCESS on success, or an error code (<0).
+ */
+int rpc_request_ex(const char* name, const void* args, uint16_t args_len,
+                   void* resp_buf, uint16_t* resp_len, uint32_t timeout_ms,
+                   const rpc_call_opts_t* opts);
+
+
+/**
+ * @brief Perform several remote procedure calls with a single wait.
+ *
+ * The requests are sent back to back, so their round trips overlap, and
+ * the caller is woken once, when the last of them has its outcome or the
+ * common deadline passes. Each entry gets its own result in @c rc (and
+ * response length in @c resp_len). With all request slots in flight,
+ * entries queue for one like rpc_request() callers; those that find none
+ * before the deadline fail with RPC_ERROR.
+ *
+ * @param entries   Calls: name, arguments and response buffer of each.
+ * @param n         Number of calls, at most RPC_BATCH_MAX (and no more
+ *                  than the requests that can be in flight).
+ * @param timeout_ms Timeout of the whole batch (ms).
+ *
+ * @return RPC_SUCCESS if every call succeeded, otherwise the result of
+ *         the first failed entry.
+ */
+int rpc_request_batch(rpc_batch_entry_t* entries, size_t n, uint32_t timeout_ms);
+
+
+/**
+ * @brief Perform a remote procedure call without waiting.
+ *
+ * The outcome (response, error or timeout) is passed to @p done by the
+ * executor chosen at rpc_init_ex(); by default from rpc_poll(), in the
+ * thread calling it. Never waits for a request slot: if none is free it
+ * fails at once with RPC_ERROR_BUSY, without calling @p done.
+ *
+ * @param name      Null-terminated function name to call.
+ * @param args      Pointer to arguments buffer (may be NULL if no args).
+ * @param args_len  Length of arguments.
+ * @param timeout_ms Timeout to wait for response (ms).
+ * @param done      Completion callback.
+ * @param user      Passed to @p done.
+ *
+ * @return RPC_SUCCESS if the request was sent, or an error code (<0).
+ */
+int rpc_request_async(const char* name, const void* args, uint16_t args_len,
+                      uint32_t timeout_ms, rpc_done_fn done, void* user);
+
+
+/**
+ * @brief Executor running completion callbacks where requests resolve.
+ *
+ * Use as @c executor.submit in rpc_init_cfg_t: @p task runs at once, in
+ * the calling thread.
+ *
+ * @param task      Task to run.
+ * @param arg       Argument of @p task.
+ * @param ctx       Unused.
+ */
+void rpc_exec_inline(rpc_task_fn task, void* arg, void* ctx);
+
+
+/**
+ * @brief Perform a remote procedure call, returning a future at once.
+ *
+ * Lets one thread keep many calls in flight: issue them back to back and
+ * collect the outcomes with rpc_future_get(), rpc_wait_any() or
+ * rpc_wait_all(). Every future must be passed to rpc_future_get() or
+ * rpc_future_release() exactly once; until then it holds a request slot.
+ * Never waits for a request slot: if none is free it fails at once with
+ * RPC_ERROR_BUSY (the calling thread may hold the futures that would free
+ * one).
+ *
+ * @param name      Null-terminated function name to call.
+ * @param args      Pointer to arguments buffer (may be NULL if no args).
+ * @param args_len  Length of arguments.
+ * @param timeout_ms Timeout to wait for response (ms).
+ * @param out       Future of the request (NULL on failure).
+ *
+ * @return RPC_SUCCESS if the request was sent, or an error code (<0).
+ */
+int rpc_request_future(const char* name, const void* args, uint16_t args_len,
+                       uint32_t timeout_ms, rpc_future_t* out);
+
+
+/**
+ * @brief Wait until the request of a future has its outcome.
+ *
+ * A future is waited for by one thread at a time.
+ *
+ * @param f         Future.
+ * @param timeout_ms Longest wait (ms), 0 to check without waiting.
+ *
+ * @return RPC_SUCCESS once the outcome is there (success or not),
+ *         RPC_ERROR_TIMEOUT while still pending.
+ */
+int rpc_future_wait(rpc_future_t f, uint32_t timeout_ms);
+
+
+/**
+ * @brief Take the outcome of a future and release it.
+ *
+ * Waits for the outcome if needed (at most the request's timeout).
+ *
+ * @param f         Future, invalid afterwards.
+ * @param resp_buf  Buffer to receive response data.
+ * @param resp_len  In: capacity of @p resp_buf. Out: actual response length.
+ *
+ * @return Result of the call (RPC_SUCCESS, RPC_ERROR_TIMEOUT, ...), or
+ *         RPC_ERROR_OVERFLOW if the response does not fit @p resp_buf.
+ */
+int rpc_future_get(rpc_future_t f, void* resp_buf, uint16_t* resp_len);
+
+
+/**
+ * @brief Release a future without taking its outcome.
+ *
+ * The request keeps its slot until it resolves; its response is dropped.
+ *
+ * @param f         Future, invalid afterwards.
+ */
+void rpc_future_release(rpc_future_t f);
+
+
+/**
+ * @brief Wait until any of several futures has its outcome.
+ *
+ * @param fs        Futures.
+ * @param n         Number of futures.
+ * @param timeout_ms Longest wait (ms).
+ *
+ * @return Index in @p fs of a resolved future (the lowest one), or
+ *         RPC_ERROR_TIMEOUT if none resolved in time.
+ */
+int rpc_wait_any(const rpc_future_t* fs, size_t n, uint32_t timeout_ms);
+
+
+/**
+ * @brief Wait until all of several futures have their outcome.
+ *
+ * @param fs        Futures.
+ * @param n         Number of futures.
+ * @param timeout_ms Longest wait for all of them (ms).
+ *
+ * @return RPC_SUCCESS once all resolved, or RPC_ERROR_TIMEOUT.
+ */
+int rpc_wait_all(const rpc_future_t* fs, size_t n, uint32_t timeout_ms);
+
+
+/**
+ * @brief Descriptor for integrating RPC into an existing event loop.
+ *
+ * Becomes readable when asynchronous completions (or, with
+ * @c poll_streams, incoming streams) are waiting; watch it with epoll,
+ * poll, libuv, ... and call rpc_poll() when it fires.
+ *
+ * @return File descriptor, valid after rpc_init().
+ */
+int rpc_poll_fd(void);
+
+
+/**
+ * @brief Deliver pending completions and streams in the calling thread.
+ *
+ * Never blocks. Runs a bounded batch per call; if more work is left the
+ * descriptor of rpc_poll_fd() stays readable.
+ *
+ * @return Number of callbacks and stream handlers run.
+ */
+int rpc_poll(void);
+
+
 /**
  * @brief Send a stream message (asynchronous, no response expected).
  *
@@ -74,4 +375,88 @@ int rpc_request(const char* name, const void* args, uint16_t args_len,
 int rpc_stream(const char* name, const void* args, uint16_t args_len);
 
 
+/**
+ * @brief Read the statistics of every RPC queue.
+ *
+ * Covers the inter-layer queues ("link_to_trans", "trans_to_link"), the
+ * request queue of every dispatch class ("rpc_requests" for the default
+ * class, "rpc_requests.<name>" for the others; their per-worker deques
+ * "rpc_requests/<n>", ... with work stealing), the rpc_poll() queues ("poll_done", "poll_streams") and
+ * the buffer pool free lists ("buf_rx_small", ...).
+ *
+ * @param out Output array.
+ * @param max Capacity of @p out.
+ * @return Number of queues (may exceed @p max; only @p max are written).
+ */
+size_t rpc_stats_queues(os_queue_stats_t* out, size_t max);
+
+
+/**
+ * @brief Read the statistics of one RPC queue by name.
+ *
+ * @param name Queue name (see rpc_stats_queues()).
+ * @param out Output snapshot.
+ * @return RPC_SUCCESS on success, RPC_ERROR if no queue has that name.
+ */
+int rpc_stats_queue(const char* name, os_queue_stats_t* out);
+
+
+/**
+ * @brief Read the statistics of the request queue of a dispatch class.
+ *
+ * With work stealing the deques of the class's workers are summed (the
+ * high-water mark is then the sum of theirs, an upper bound).
+ *
+ * @param dispatch_class Class index, 0 for the default class.
+ * @param out Output snapshot.
+ * @return RPC_SUCCESS on success, RPC_ERROR for an unknown class.
+ */
+int rpc_stats_class(uint8_t dispatch_class, os_queue_stats_t* out);
+
+
+/**
+ * @brief Read the worker pool statistics of a dispatch class.
+ *
+ * Reports the threads running now, next to the pool's bounds, its
+ * high-water mark, how many workers were started and retired, and how
+ * many requests were shed because their caller's deadline had passed.
+ *
+ * @param dispatch_class Class index, 0 for the default class.
+ * @param out Output snapshot.
+ * @return RPC_SUCCESS on success, RPC_ERROR for an unknown class.
+ */
+int rpc_stats_pool(uint8_t dispatch_class, rpc_pool_stats_t* out);
+
+
+/**
+ * @brief Read the contention statistics of every RPC lock.
+ *
+ * Covers the transport mutexes ("tx_mtx", "worker_count", "reg_mtx",
+ * "wait_mtx") and the deadline timer wheel ("timer_wheel").
+ *
+ * @param out Output array.
+ * @param max Capacity of @p out.
+ * @return Number of locks (may exceed @p max; only @p max are written).
+ */
+size_t rpc_stats_mutexes(os_mutex_stats_t* out, size_t max);
+
+
+/**
+ * @brief Read the contention statistics of one RPC lock by name.
+ *
+ * @param name Lock name (see rpc_stats_mutexes()).
+ * @param out Output snapshot.
+ * @return RPC_SUCCESS on success, RPC_ERROR if no lock has that name.
+ */
+int rpc_stats_mutex(const char* name, os_mutex_stats_t* out);
+
+
+/**
+ * @brief Print a table of all RPC statistics.
+ *
+ * @param out Output stream (e.g. stdout).
+ */
+void rpc_stats_print(FILE* out);
+
+
 #endif /* RPC_H_ */
@@ -0,0 +1,98 @@
+/**
+ * @file    rpc_buf.h
+ * @brief   Reference-counted payload buffer pool.
+ *
+ * Received requests and streams are handed to the workers (or the reactor
+ * handler) as handles to pool buffers, so a payload is not copied again
+ * while it waits for a worker. Each pool has fixed size classes, and every
+ * buffer keeps room before and after the payload so the link layer can
+ * frame it in place. Payloads crossing the link/transport boundary in the
+ * threaded runtime travel through byte rings instead (see os_ring_create()).
+ */
+
+#ifndef RPC_BUF_H_
+#define RPC_BUF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include "rpc_osal.h"
+
+
+// === Pools ===
+
+/**
+ * @brief Buffer pool identifiers.
+ *
+ * Outgoing payloads are written straight into the transport-to-link ring
+ * (or a stack frame with the reactor runtime), so only received payloads
+ * need a pool.
+ */
+typedef enum {
+	RPC_BUF_POOL_RX,    /**< Payloads received from the link layer */
+	RPC_BUF_POOL_COUNT  /**< Number of pools */
+} rpc_buf_pool_t;
+
+
+// === Data Structures ===
+
+/**
+ * @brief Pool buffer handle.
+ */
+typedef struct {
+	atomic_uint refs;  /**< Reference count, buffer returns to its pool at 0 */
+	uint8_t pool;      /**< Owning pool (rpc_buf_pool_t) */
+	uint8_t cls;       /**< Owning size class */
+	uint16_t cap;      /**< Payload capacity in bytes */
+	uint16_t len;      /**< Actual payload length */
+	uint8_t* data;     /**< Payload start (link headroom lies in front of it) */
+} rpc_buf_t;
+
+
+// === Function Prototypes ===
+
+/**
+ * @brief Initialize the buffer pools.
+ *
+ * Must be called before any other buffer operation.
+ *
+ * @return RPC_SUCCESS on success, RPC_ERROR on failure.
+ */
+int rpc_buf_init(void);
+
+/**
+ * @brief OSAL arena bytes needed by rpc_buf_init().
+ *
+ * @return Footprint of the free lists.
+ */
+size_t rpc_buf_arena_size(void);
+
+/**
+ * @brief Allocate a buffer able to hold @p len payload bytes.
+ *
+ * Takes the smallest size class that fits, falling back to larger classes
+ * when it is exhausted. The returned buffer has one reference and len = 0.
+ *
+ * @param pool Pool to allocate from.
+ * @param len Required payload capacity.
+ * @param timeout_ms Time to wait for a free buffer (OS_WAIT_FOREVER for blocking).
+ * @return Buffer handle, or NULL if none became available in time.
+ */
+rpc_buf_t* rpc_buf_alloc(rpc_buf_pool_t pool, size_t len, uint32_t timeout_ms);
+
+/**
+ * @brief Take an additional reference to a buffer.
+ *
+ * @param b Buffer handle.
+ */
+void rpc_buf_ref(rpc_buf_t* b);
+
+/**
+ * @brief Drop a reference; the last one returns the buffer to its pool.
+ *
+ * @param b Buffer handle (NULL is ignored).
+ */
+void rpc_buf_release(rpc_buf_t* b);
+
+#endif /* RPC_BUF_H_ */
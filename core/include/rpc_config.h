@@ -16,7 +16,27 @@
 // === Log level ===
 
 /** Default log level for the RPC system */
+#ifndef RPC_LOG_LEVEL
 #define RPC_LOG_LEVEL    RPC_LOG_LEVEL_INFO
+#endif
+
+
+// === Runtime Configuration ===
+
+/** Runtime used by rpc_init(): RPC_RUNTIME_THREADED or RPC_RUNTIME_REACTOR */
+#define RPC_RUNTIME_DEFAULT          RPC_RUNTIME_THREADED
+
+/** Arena mode used by rpc_init() (0/1), see rpc_init_cfg_t */
+#define RPC_ARENA_DEFAULT            0
+
+/** OS_ARENA_* flags used by rpc_init() in arena mode */
+#define RPC_ARENA_FLAGS_DEFAULT      0
+
+/** Arena bytes reserved on top of the computed object footprint */
+#define RPC_ARENA_SLACK           4096
+
+/** Bytes the reactor reads from PHY per readiness event */
+#define RPC_REACTOR_RX_CHUNK         256
 
 
 // === Function Configuration ===
@@ -33,34 +53,193 @@
 
 // === System Limits ===
 
-/** Maximum number of registered functions */
+/** Registered functions the registry holds before it first grows */
 #define NUM_REG_FUNC                 16
 
-/** Size of the request waiter table */
-#define REQ_TABLE_SIZE                8
+/** Method IDs of the shared method table are below this bound (size of the ID dispatch array) */
+#define RPC_METHOD_ID_MAX           256
+
+/** Request waiters the table starts with, and grows by when all are in flight */
+#define REQ_TABLE_SIZE               16
+
+/**
+ * Largest number of requests in flight (power of two, multiple of
+ * REQ_TABLE_SIZE). The low bits of a sequence number index the waiter
+ * table, the rest count the waiter's reuses, so a response can only be
+ * mistaken for a later request after 2^32 / RPC_WAITER_MAX reuses of its
+ * waiter.
+ */
+#define RPC_WAITER_MAX             4096
+
+/**
+ * Requests in flight in arena mode (multiple of REQ_TABLE_SIZE, at most
+ * RPC_WAITER_MAX). The table cannot grow once the arena is sealed, so
+ * all of them are created at init.
+ */
+#define RPC_ARENA_WAITERS          1024
+
+/**
+ * Callers that can queue, in arrival order, for a free waiter while all
+ * RPC_WAITER_MAX are in flight; more wait unordered.
+ */
+#define RPC_WAITER_PARK_MAX          64
 
-/** Number of RPC worker threads */
+/** Most calls in one rpc_request_batch() */
+#define RPC_BATCH_MAX                64
+
+/** Number of RPC worker threads (of the default dispatch class) */
 #define RPC_WORKER_COUNT              1
 
+/** Most worker threads of the default dispatch class; above RPC_WORKER_COUNT its pool is elastic */
+#define RPC_WORKER_MAX                RPC_WORKER_COUNT
+
+/** Most dispatch classes, the default class included */
+#define RPC_CLASS_MAX                 4
+
+/** How workers share the requests of a class (RPC_SCHED_SHARED or RPC_SCHED_STEAL), see rpc_init_cfg_t */
+#define RPC_SCHED_MODE_DEFAULT        RPC_SCHED_SHARED
+
+
+// === Thread Configuration ===
+// Policy:   OS_SCHED_DEFAULT (time-sharing), OS_SCHED_FIFO or OS_SCHED_RR (real-time,
+//           needs CAP_SYS_NICE on Linux; falls back to default scheduling otherwise)
+// Priority: real-time priority, ignored with OS_SCHED_DEFAULT
+// CPU mask: bit n allows CPU n, 0 allows any CPU (e.g. pin RX/TX to an isolated core)
+
+/** RX thread (PHY -> LINK) scheduling */
+#define RPC_THREAD_RX_POLICY          OS_SCHED_DEFAULT
+#define RPC_THREAD_RX_PRIORITY        0
+#define RPC_THREAD_RX_CPU_MASK        0
+
+/** TX thread (LINK -> PHY) scheduling */
+#define RPC_THREAD_TX_POLICY          OS_SCHED_DEFAULT
+#define RPC_THREAD_TX_PRIORITY        0
+#define RPC_THREAD_TX_CPU_MASK        0
+
+/** Transport thread scheduling */
+#define RPC_THREAD_TRANS_POLICY       OS_SCHED_DEFAULT
+#define RPC_THREAD_TRANS_PRIORITY     0
+#define RPC_THREAD_TRANS_CPU_MASK     0
+
+/** Worker threads scheduling */
+#define RPC_THREAD_WORKER_POLICY      OS_SCHED_DEFAULT
+#define RPC_THREAD_WORKER_PRIORITY    0
+#define RPC_THREAD_WORKER_CPU_MASK    0
+
+/** Timer thread scheduling (request/handler deadlines, RPC_RUNTIME_THREADED only) */
+#define RPC_THREAD_TIMER_POLICY       OS_SCHED_DEFAULT
+#define RPC_THREAD_TIMER_PRIORITY     0
+#define RPC_THREAD_TIMER_CPU_MASK     0
+
+/** Reactor event loop thread scheduling (RPC_RUNTIME_REACTOR only) */
+#define RPC_THREAD_REACTOR_POLICY     OS_SCHED_DEFAULT
+#define RPC_THREAD_REACTOR_PRIORITY   0
+#define RPC_THREAD_REACTOR_CPU_MASK   0
+
+/** Use priority-inheritance mutexes for locks shared between thread roles (0/1) */
+#define RPC_MUTEX_PRIO_INHERIT        0
+
 
 // === Queue Configuration ===
 
-/** Depth of link-to-transport queue */
-#define Q_LINK_TO_TRANS_DEPTH        16
+/**
+ * Size in bytes of the link-to-transport byte ring (received payloads,
+ * rounded up to a power of two). Each record takes its payload plus 24 bytes,
+ * and the ring must fit two full-size records: 512 holds 16 small requests,
+ * about the worker queue depth, so the RX thread is held back before the
+ * transport thread would have to drop requests.
+ */
+#define Q_LINK_TO_TRANS_BYTES        512
 
-/** Depth of transport-to-link queue */
-#define Q_TRANS_TO_LINK_DEPTH        16
+/** Size in bytes of the transport-to-link byte ring (frames to send, rounded up to a power of two) */
+#define Q_TRANS_TO_LINK_BYTES        1024
 
 /** Depth of RPC request queue for workers */
 #define Q_RPC_REQUEST_DEPTH          16
 
+/** Maximum messages the TX and transport threads drain from their queue per wakeup */
+#define Q_DRAIN_BATCH                8
+
+/** Maximum requests a worker takes per wakeup (larger values trade fairness between workers for fewer wakeups) */
+#define RPC_WORKER_BATCH             4
+
+
+// === Elastic Worker Pool ===
+// Applies to dispatch classes whose max_workers exceeds workers. Not in
+// arena mode, where no thread may be created after rpc_start(): such a
+// class then runs at its maximum.
+
+/** Start a worker when this many requests of a class are queued and none of its workers is idle */
+#define RPC_POOL_GROW_DEPTH          4
+
+/** Start a worker when a request waited longer than this in the class queue (us) and none is idle */
+#define RPC_POOL_GROW_RESIDENCE_US   2000
+
+/** Retire a worker above the class minimum after it found no request for this long (ms) */
+#define RPC_POOL_LINGER_MS           5000
+
+
+/** Collect per-queue depth, blocking, timeout and residence-time statistics (0/1) */
+#ifndef RPC_QUEUE_STATS
+#define RPC_QUEUE_STATS               1
+#endif
+
+/** Residence time is measured for one in this many queued items (power of two) */
+#define RPC_QUEUE_STATS_SAMPLE       16
+
+/** Collect per-mutex acquisition, contention, wait and hold-time statistics (0/1) */
+#ifndef RPC_MUTEX_STATS
+#define RPC_MUTEX_STATS               1
+#endif
+
+/** Hold time is measured for one in this many uncontended acquisitions */
+#define RPC_MUTEX_STATS_SAMPLE       16
+
+
+// === Buffer Pool Configuration ===
+
+/** Payload capacity of small pool buffers in bytes (larger payloads use full-size buffers) */
+#define RPC_BUF_SMALL_SIZE           24
+
+/** Number of small RX buffers */
+#define RPC_BUF_SMALL_COUNT          32
+
+/** Number of full-size RX buffers */
+#define RPC_BUF_LARGE_COUNT          32
+
 
 // === Timeout Configuration ===
 
 /** Default request timeout in milliseconds */
 #define REQ_TIMEOUT_MS_DEFAULT      200
 
+/** Resolution of the deadline timer wheel in milliseconds */
+#define RPC_TIMER_TICK_MS             1
+
 /** Default handler execution timeout in milliseconds */
 #define HANDLER_TIMEOUT_MS_DEFAULT  150
 
+/**
+ * Send the caller's remaining time with each request (1) so the server
+ * sheds requests whose caller has given up and hands the rest to the
+ * handler as its timeout_ms. Both peers must agree.
+ */
+#define RPC_DEADLINE_BUDGET           1
+
+
+// === Response Wait Configuration ===
+
+/**
+ * Wait strategy of rpc_request() (RPC_WAIT_PARK or RPC_WAIT_ADAPTIVE), see
+ * rpc_init_cfg_t. Adaptive waits burn CPU while spinning, so they are
+ * opt-in.
+ */
+#define RPC_WAIT_MODE_DEFAULT        RPC_WAIT_PARK
+
+/** Longest spin of an adaptive wait in microseconds; methods slower than this park at once */
+#define RPC_WAIT_SPIN_MAX_US         50
+
+/** Number of remote methods with a round-trip estimate (power of two; colliding names share one) */
+#define RPC_RTT_TABLE_SIZE           64
+
 #endif /* RPC_CONFIG_H_ */
@@ -18,6 +18,7 @@
 #define RPC_ERROR_OVERFLOW          -2 /**< Buffer overflow or size exceeded */
 #define RPC_ERROR_TIMEOUT           -3 /**< Operation timed out */
 #define RPC_ERROR_INVALID_ARGS      -4 /**< Invalid arguments provided */
+#define RPC_ERROR_BUSY              -5 /**< No request slot free (calls that do not wait for one) */
 
 
 // === Utility Macros ===
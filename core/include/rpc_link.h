@@ -14,6 +14,7 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "rpc_buf.h"
 #include "rpc_crc8.h"
 #include "rpc_errors.h"
 #include "rpc_log.h"
@@ -36,15 +37,17 @@
 #define CRC_PKT_SIZE        1    /** Packet CRC field size */
 #define EOF_SIZE            1    /** End Of Frame marker size */
 #define TYPE_MSG_SIZE       1    /** Message type field size */
-#define SEQ_MSG_SIZE        1    /** Sequence number field size */
+#define SEQ_MSG_SIZE        4    /** Sequence number field size (little-endian) */
 #define TERM_SIZE           1    /** String terminator size */
+#define METHOD_ID_SIZE      2    /** Method ID field size (sent in place of the name) */
+#define BUDGET_MSG_SIZE     2    /** Deadline budget field size (requests, little-endian ms) */
 
-/** Minimum payload size: type + seq + min_func_name + terminator */
-#define MIN_PAYLOAD_SIZE    (TYPE_MSG_SIZE + SEQ_MSG_SIZE + MIN_FUNC_NAME_LEN + TERM_SIZE)
+/** Minimum payload size: type + seq + method_id (no named message is shorter) */
+#define MIN_PAYLOAD_SIZE    (TYPE_MSG_SIZE + SEQ_MSG_SIZE + METHOD_ID_SIZE)
 
-/** Maximum payload size: type + seq + max_func_name + terminator + max_args */
-#define MAX_PAYLOAD_SIZE    (TYPE_MSG_SIZE + SEQ_MSG_SIZE + MAX_FUNC_NAME_LEN + TERM_SIZE \
-		                     + MAX_FUNC_ARGS_RESP_SIZE)
+/** Maximum payload size: type + seq + budget + max_func_name + terminator + max_args */
+#define MAX_PAYLOAD_SIZE    (TYPE_MSG_SIZE + SEQ_MSG_SIZE + BUDGET_MSG_SIZE + MAX_FUNC_NAME_LEN \
+		                     + TERM_SIZE + MAX_FUNC_ARGS_RESP_SIZE)
 
 /** Maximum packet length: SOD + max_payload + pkt_crc + EOF */
 #define MAX_PKT_LEN         (SOD_SIZE + MAX_PAYLOAD_SIZE + CRC_PKT_SIZE + EOF_SIZE)
@@ -52,18 +55,17 @@
 /** Minimum packet length: SOD + min_payload + pkt_crc + EOF */
 #define MIN_PKT_LEN         (SOD_SIZE + MIN_PAYLOAD_SIZE + CRC_PKT_SIZE + EOF_SIZE)
 
-// === Data Structures ===
+/** Room kept in front of a payload framed in place: header + SOD */
+#define LINK_HEADROOM       (HEADER_SIZE + SOD_SIZE)
 
-/**
- * @brief Link layer payload event structure.
- *
- * This structure represents a complete payload packet ready for
- * upper layers (without SOD, packet CRC, and EOF markers).
- */
-typedef struct {
-	uint8_t payload[MAX_PAYLOAD_SIZE];    /**< Payload data buffer */
-	size_t payload_len;                   /**< Actual payload length */
-} link_payload_t;
+/** Room kept behind a payload framed in place: pkt_crc + EOF */
+#define LINK_TAILROOM       (CRC_PKT_SIZE + EOF_SIZE)
+
+
+// === Types ===
+
+/** Consumer of received frames; takes ownership of the buffer reference */
+typedef void (*rpc_link_rx_fn)(rpc_buf_t* b);
 
 
 // === Function Prototypes ===
@@ -78,15 +80,27 @@ void rpc_link_init(void);
 /**
  * @brief Feed raw bytes to the link layer parser.
  *
- * Processes incoming bytes through the state machine. When a complete
- * frame is successfully assembled, it sends the payload to the
- * qLinkToTrans queue.
+ * Processes incoming bytes through the state machine. The payload is
+ * written straight into a record reserved in the qLinkToTrans byte ring,
+ * which is committed when a complete frame is successfully assembled.
  *
  * @param data Pointer to raw byte data.
  * @param len Number of bytes to process.
  */
 void rpc_link_feed_bytes(const uint8_t* data, size_t len);
 
+/**
+ * @brief Deliver received frames to a function instead of qLinkToTrans.
+ *
+ * Used by the reactor runtime, where the thread parsing the frames also
+ * processes them. Payloads are then received into RX pool buffers, and the
+ * handler runs inside rpc_link_feed_bytes(). A frame arriving while no
+ * buffer is free is dropped instead of waited for.
+ *
+ * @param fn Frame consumer, NULL to queue frames to qLinkToTrans (default).
+ */
+void rpc_link_set_rx_handler(rpc_link_rx_fn fn);
+
 /**
  * @brief Build a link frame from payload and send via PHY layer.
  *
@@ -99,6 +113,19 @@ void rpc_link_feed_bytes(const uint8_t* data, size_t len);
  */
 int rpc_link_build_frame(const uint8_t* payload, size_t len);
 
+/**
+ * @brief Frame a payload in place and send it via PHY layer.
+ *
+ * Writes the header into the LINK_HEADROOM bytes in front of the payload
+ * and the CRC/EOF into the LINK_TAILROOM bytes behind it, so the payload
+ * is never copied.
+ *
+ * @param frame Frame start; the payload is at frame + LINK_HEADROOM.
+ * @param len Length of payload data.
+ * @return RPC_SUCCESS on success, RPC_ERROR on failure.
+ */
+int rpc_link_send_frame(uint8_t* frame, size_t len);
+
 /**
  * @brief Start the RX thread for link layer.
  *
@@ -54,7 +54,7 @@
     printf("\n"); \
 } while (0)
 #else
-#define RPC_LOG_ERROR(...)
+#define RPC_LOG_ERROR(...) do { } while (0)
 #endif
 
 
@@ -73,7 +73,7 @@
     printf("\n"); \
 } while (0)
 #else
-#define RPC_LOG_INFO(...)
+#define RPC_LOG_INFO(...) do { } while (0)
 #endif
 
 
@@ -92,7 +92,7 @@
     printf("\n"); \
 } while (0)
 #else
-#define RPC_LOG_DEBUG(...)
+#define RPC_LOG_DEBUG(...) do { } while (0)
 #endif
 
 
@@ -111,7 +111,7 @@
     printf("\n"); \
 } while (0)
 #else
-#define RPC_LOG_TRACE(...)
+#define RPC_LOG_TRACE(...) do { } while (0)
 #endif
 
 
@@ -3,7 +3,8 @@
  * @brief   RPC OS Abstraction Layer interface.
  *
  * This header provides platform-independent OS abstraction for RPC system.
- * It defines interfaces for threads, queues, semaphores, and mutexes.
+ * It defines interfaces for threads, queues, semaphores, mutexes, and
+ * descriptor polling with timers.
  */
 
 
@@ -36,7 +37,8 @@ typedef struct os_thread* os_thread_t;
  * @param fn Thread function to execute.
  * @param arg Argument passed to thread function.
  * @param stack_size Stack size in bytes.
- * @param priority Thread priority (implementation specific).
+ * @param priority Thread priority, 0 for default scheduling; higher values
+ *                 request real-time (FIFO) scheduling where permitted.
  * @return Thread handle on success, NULL on failure.
  */
 os_thread_t os_thread_create(const char* name,
@@ -46,9 +48,58 @@ os_thread_t os_thread_create(const char* name,
                              uint8_t priority);
 
 
+/**
+ * @brief Scheduling policies for os_thread_create_ex().
+ */
+typedef enum {
+    OS_SCHED_DEFAULT, /**< Normal time-sharing scheduling, priority is ignored */
+    OS_SCHED_FIFO,    /**< Real-time, run until blocked or preempted */
+    OS_SCHED_RR       /**< Real-time, round-robin among equal priorities */
+} os_sched_policy_t;
+
+
+/**
+ * @brief Extended thread attributes.
+ */
+typedef struct {
+    const char* name;          /**< Thread name (may be truncated by the OS) */
+    uint32_t stack_size;       /**< Stack size in bytes, 0 for the OS default */
+    os_sched_policy_t policy;  /**< Scheduling policy */
+    uint8_t priority;          /**< Real-time priority, clamped to the OS range */
+    uint64_t cpu_mask;         /**< Allowed CPUs (bit n = CPU n), 0 for any */
+} os_thread_attr_t;
+
+
+/**
+ * @brief Create a new thread with explicit scheduling attributes.
+ *
+ * Real-time policies usually need privileges; when the OS refuses them the
+ * thread is still created with default scheduling.
+ *
+ * @param attr Thread attributes.
+ * @param fn Thread function to execute.
+ * @param arg Argument passed to thread function.
+ * @return Thread handle on success, NULL on failure.
+ */
+os_thread_t os_thread_create_ex(const os_thread_attr_t* attr,
+                                os_thread_fn fn,
+                                void* arg);
+
+
+/**
+ * @brief Let a thread's resources be reclaimed as soon as it returns.
+ *
+ * For threads that end on their own; nobody waits for them. The handle
+ * is invalid afterwards.
+ *
+ * @param t Thread handle.
+ */
+void os_thread_detach(os_thread_t t);
+
+
 /* ---------- Queues ---------- */
 
-/** Queue handle type */
+/** Queue handle type (shared by all queue flavours) */
 typedef struct os_queue* os_queue_t;
 
 
@@ -84,6 +135,255 @@ bool os_queue_send(os_queue_t q, const void* item, uint32_t timeout_ms);
 bool os_queue_recv(os_queue_t q, void* item, uint32_t timeout_ms);
 
 
+/**
+ * @brief Send up to @p n items to the queue.
+ *
+ * Waits (up to @p timeout_ms) until at least one slot is free, then sends
+ * as many items as fit without waiting again. The batch costs a single
+ * synchronization round and wakes receivers once, so callers holding
+ * several items should prefer it to repeated os_queue_send().
+ *
+ * @param q Queue handle.
+ * @param items Array of @p n items, stored back to back.
+ * @param n Number of items in @p items.
+ * @param timeout_ms Timeout in milliseconds (OS_WAIT_FOREVER for blocking).
+ * @return Number of items sent (the first ones of @p items), 0 on timeout.
+ */
+size_t os_queue_send_n(os_queue_t q, const void* items, size_t n, uint32_t timeout_ms);
+
+
+/**
+ * @brief Receive up to @p n items from the queue.
+ *
+ * Waits (up to @p timeout_ms) until at least one item is available, then
+ * takes everything available up to @p n without waiting again, so a
+ * consumer can drain a burst with one synchronization round.
+ *
+ * @param q Queue handle.
+ * @param items Buffer for up to @p n items, stored back to back.
+ * @param n Capacity of @p items in items.
+ * @param timeout_ms Timeout in milliseconds (OS_WAIT_FOREVER for blocking).
+ * @return Number of items received, 0 on timeout.
+ */
+size_t os_queue_recv_n(os_queue_t q, void* items, size_t n, uint32_t timeout_ms);
+
+
+/* ---------- SPSC Queues ---------- */
+
+/**
+ * @brief Create a single-producer/single-consumer queue.
+ *
+ * The returned handle is used with os_queue_send() / os_queue_recv() like
+ * any other queue, but the caller guarantees that at most one thread sends
+ * and at most one thread receives. This allows a lock-free implementation
+ * where neither side takes a lock and the OS is only involved when a side
+ * has to block. Ports without such primitives may simply forward to
+ * os_queue_create().
+ *
+ * @param length Maximum number of items in queue (may be rounded up).
+ * @param item_size Size of each item in bytes.
+ * @return Queue handle on success, NULL on failure.
+ */
+os_queue_t os_spsc_queue_create(size_t length, size_t item_size);
+
+
+/* ---------- MPMC Queues ---------- */
+
+/**
+ * @brief Create a bounded lock-free multi-producer/multi-consumer queue.
+ *
+ * The returned handle is used with os_queue_send() / os_queue_recv() and
+ * may be shared by any number of senders and receivers. Unlike the default
+ * queue, senders and receivers do not serialize on a single lock; blocked
+ * callers are parked and only woken when an item or a free slot appears.
+ * Ports without such primitives may simply forward to os_queue_create().
+ *
+ * @param length Maximum number of items in queue (may be rounded up).
+ * @param item_size Size of each item in bytes.
+ * @return Queue handle on success, NULL on failure.
+ */
+os_queue_t os_mpmc_queue_create(size_t length, size_t item_size);
+
+
+/* ---------- In-Place Queue Access ---------- */
+
+/**
+ * @brief Reserve the next free slot of a queue for writing in place.
+ *
+ * The producer builds the item directly in the returned slot and publishes
+ * it with os_queue_commit(), so nothing is copied through a stack item.
+ * Works with every queue flavour; on the default (locked) queue the queue
+ * lock is held until the commit, so keep the window short. A thread holds
+ * at most one reservation per queue at a time.
+ *
+ * @param q Queue handle.
+ * @param timeout_ms Timeout in milliseconds (OS_WAIT_FOREVER for blocking).
+ * @return Slot of item_size bytes, NULL on failure or timeout.
+ */
+void* os_queue_reserve(os_queue_t q, uint32_t timeout_ms);
+
+
+/**
+ * @brief Publish a slot obtained from os_queue_reserve().
+ *
+ * @param q Queue handle.
+ * @param slot Reserved slot.
+ */
+void os_queue_commit(os_queue_t q, void* slot);
+
+
+/**
+ * @brief Access the oldest item of a queue in place.
+ *
+ * The consumer reads (or parses) the item where it lies and hands the slot
+ * back with os_queue_release(). The same restrictions as for
+ * os_queue_reserve() apply.
+ *
+ * @param q Queue handle.
+ * @param timeout_ms Timeout in milliseconds (OS_WAIT_FOREVER for blocking).
+ * @return Item slot, NULL on failure or timeout.
+ */
+const void* os_queue_peek(os_queue_t q, uint32_t timeout_ms);
+
+
+/**
+ * @brief Free a slot obtained from os_queue_peek().
+ *
+ * @param q Queue handle.
+ * @param slot Peeked slot.
+ */
+void os_queue_release(os_queue_t q, const void* slot);
+
+
+/* ---------- Byte Rings ---------- */
+
+/**
+ * @brief Create a byte ring of variable-length records.
+ *
+ * Each record occupies only its own length plus a small header, so the
+ * memory in use follows the bytes in flight instead of a worst-case item
+ * size. Any number of threads may produce; one thread consumes. Records
+ * are written and read in place with os_ring_reserve() / os_ring_commit()
+ * and os_ring_peek() / os_ring_release(); the handle also works with
+ * os_queue_set_name() and the statistics (capacity and depth in bytes).
+ * Ports without such primitives may implement it over a mutex.
+ *
+ * @param bytes Ring size in bytes (may be rounded up).
+ * @return Queue handle on success, NULL on failure.
+ */
+os_queue_t os_ring_create(size_t bytes);
+
+
+/**
+ * @brief Reserve a record of @p len bytes for writing in place.
+ *
+ * Records are consumed in reservation order, so a reservation should be
+ * committed promptly: an open one holds back the records behind it.
+ *
+ * @param q Ring handle.
+ * @param len Record length, at most half the ring size.
+ * @param timeout_ms Timeout in milliseconds (OS_WAIT_FOREVER for blocking).
+ * @return Record data, NULL on failure or timeout.
+ */
+void* os_ring_reserve(os_queue_t q, size_t len, uint32_t timeout_ms);
+
+
+/**
+ * @brief Publish a reserved record.
+ *
+ * @param q Ring handle.
+ * @param rec Record from os_ring_reserve().
+ * @param len Bytes actually written (at most the reserved length); 0
+ *            discards the record.
+ */
+void os_ring_commit(os_queue_t q, void* rec, size_t len);
+
+
+/**
+ * @brief Access the oldest record in place (consumer side).
+ *
+ * @param q Ring handle.
+ * @param len Output: record length.
+ * @param timeout_ms Timeout in milliseconds (OS_WAIT_FOREVER for blocking).
+ * @return Record data, NULL on timeout.
+ */
+const void* os_ring_peek(os_queue_t q, size_t* len, uint32_t timeout_ms);
+
+
+/**
+ * @brief Free the record returned by the last os_ring_peek().
+ *
+ * @param q Ring handle.
+ * @param rec Record data.
+ */
+void os_ring_release(os_queue_t q, const void* rec);
+
+
+/* ---------- Queue Statistics ---------- */
+
+/**
+ * Number of residence-time histogram buckets: bucket 0 counts items that
+ * stayed below 1 us, bucket i (i > 0) those in [2^(i-1), 2^i) us; the last
+ * bucket also takes everything longer.
+ */
+#define OS_QUEUE_HIST_BUCKETS  16
+
+
+/**
+ * @brief Queue statistics snapshot.
+ *
+ * Counters are cumulative since creation. Residence (enqueue to dequeue)
+ * time is measured on a sample of the items only. For byte rings items are
+ * records, while capacity, depth and high-water mark are in bytes.
+ */
+typedef struct {
+    const char* name;           /**< Name given by os_queue_set_name(), NULL if unnamed */
+    size_t capacity;            /**< Maximum number of items */
+    size_t depth;               /**< Items queued now */
+    size_t high_water;          /**< Highest depth seen */
+    uint64_t sent;              /**< Items sent */
+    uint64_t received;          /**< Items received */
+    uint64_t blocked_sends;     /**< Sends that had to wait for a free slot */
+    uint64_t blocked_send_us;   /**< Total time senders spent waiting for a free slot */
+    uint64_t send_timeouts;     /**< Sends rejected because the queue stayed full (incl. OS_NO_WAIT) */
+    uint64_t recv_timeouts;     /**< Timed receives that found no item */
+    uint64_t residence_samples; /**< Number of sampled items */
+    uint64_t residence_us;      /**< Total residence time of the sampled items */
+    uint64_t residence_hist[OS_QUEUE_HIST_BUCKETS]; /**< Residence time histogram */
+} os_queue_stats_t;
+
+
+/**
+ * @brief Name a queue and include it in os_queue_list_stats().
+ *
+ * @param q Queue handle.
+ * @param name Name (static string, must outlive the queue).
+ */
+void os_queue_set_name(os_queue_t q, const char* name);
+
+
+/**
+ * @brief Read the statistics of a queue.
+ *
+ * Ports without statistics support report only name, capacity and depth.
+ *
+ * @param q Queue handle.
+ * @param st Output snapshot.
+ * @return true on success, false on invalid arguments.
+ */
+bool os_queue_get_stats(os_queue_t q, os_queue_stats_t* st);
+
+
+/**
+ * @brief Read the statistics of every named queue.
+ *
+ * @param st Output array.
+ * @param max Capacity of @p st.
+ * @return Number of named queues (may exceed @p max; only @p max are written).
+ */
+size_t os_queue_list_stats(os_queue_stats_t* st, size_t max);
+
+
 /* ---------- Binary Semaphores ---------- */
 
 /** Binary semaphore handle type */
@@ -108,6 +408,21 @@ os_sem_t os_sem_create_binary(void);
 bool os_sem_take(os_sem_t s, uint32_t timeout_ms);
 
 
+/**
+ * @brief Take a binary semaphore, busy-polling it briefly before sleeping.
+ *
+ * For waits expected to end within microseconds, where a sleep and wakeup
+ * would cost more than the wait itself. The spin uses a CPU pause hint,
+ * or yields where there is a single CPU so the giver can run.
+ *
+ * @param s Semaphore handle.
+ * @param spin_ns Longest busy-poll in nanoseconds, 0 to behave as os_sem_take().
+ * @param timeout_ms Timeout in milliseconds, counted after the spin.
+ * @return true on success, false on failure or timeout.
+ */
+bool os_sem_take_spin(os_sem_t s, uint32_t spin_ns, uint32_t timeout_ms);
+
+
 /**
  * @brief Give (release) a binary semaphore.
  *
@@ -130,6 +445,18 @@ typedef struct os_mutex* os_mutex_t;
 os_mutex_t os_mutex_create(void);
 
 
+/**
+ * @brief Create a priority-inheritance mutex.
+ *
+ * While a higher-priority thread waits, the holder runs at that priority,
+ * so a real-time thread is not held up by a preempted low-priority holder.
+ * Ports without priority inheritance may return a plain mutex.
+ *
+ * @return Mutex handle on success, NULL on failure.
+ */
+os_mutex_t os_mutex_create_pi(void);
+
+
 /**
  * @brief Lock a mutex.
  *
@@ -146,6 +473,378 @@ void os_mutex_lock(os_mutex_t m);
 void os_mutex_unlock(os_mutex_t m);
 
 
+/* ---------- Mutex Statistics ---------- */
+
+/**
+ * @brief Mutex contention statistics snapshot.
+ *
+ * Counters are cumulative since creation. Uncontended acquisitions cost a
+ * trylock only; waits are timed on contended ones, hold time on a sample.
+ * Besides os_mutex objects, the internal locks of locked queues and timer
+ * wheels are reported (under the queue or wheel name).
+ */
+typedef struct {
+    const char* name;           /**< Name given by os_mutex_set_name(), NULL if unnamed */
+    uint64_t acquisitions;      /**< Times the lock was taken */
+    uint64_t contended;         /**< Acquisitions that found the lock held */
+    uint64_t wait_ns;           /**< Total time spent waiting in contended acquisitions */
+    uint64_t max_wait_ns;       /**< Longest wait */
+    uint64_t hold_samples;      /**< Number of sampled holds */
+    uint64_t hold_ns;           /**< Total time the lock was held in the sampled holds */
+    uint64_t max_hold_ns;       /**< Longest sampled hold */
+} os_mutex_stats_t;
+
+
+/**
+ * @brief Name a mutex and include it in os_mutex_list_stats().
+ *
+ * @param m Mutex handle.
+ * @param name Name (static string, must outlive the mutex).
+ */
+void os_mutex_set_name(os_mutex_t m, const char* name);
+
+
+/**
+ * @brief Read the contention statistics of a mutex.
+ *
+ * Ports without statistics support report only the name.
+ *
+ * @param m Mutex handle.
+ * @param st Output snapshot.
+ * @return true on success, false on invalid arguments.
+ */
+bool os_mutex_get_stats(os_mutex_t m, os_mutex_stats_t* st);
+
+
+/**
+ * @brief Read the contention statistics of every named lock.
+ *
+ * @param st Output array.
+ * @param max Capacity of @p st.
+ * @return Number of named locks (may exceed @p max; only @p max are written).
+ */
+size_t os_mutex_list_stats(os_mutex_stats_t* st, size_t max);
+
+
+/* ---------- Event Polling ---------- */
+
+/*
+ * Readiness polling over OS descriptors, used by the single-threaded
+ * reactor runtime. Ports that only run the threaded runtime may leave
+ * these unimplemented (create functions return NULL).
+ */
+
+/** Poller handle type */
+typedef struct os_poller* os_poller_t;
+
+
+/**
+ * @brief Create a poller.
+ *
+ * @return Poller handle on success, NULL on failure or if unsupported.
+ */
+os_poller_t os_poller_create(void);
+
+
+/**
+ * @brief Watch a descriptor for readability.
+ *
+ * @param p Poller handle.
+ * @param fd Descriptor to watch (level-triggered).
+ * @param ctx Value reported by os_poller_wait() when @p fd is readable.
+ * @return true on success, false on failure.
+ */
+bool os_poller_add(os_poller_t p, int fd, void* ctx);
+
+
+/**
+ * @brief Wait until at least one watched descriptor is readable.
+ *
+ * @param p Poller handle.
+ * @param ready Output: contexts of the readable descriptors.
+ * @param max Capacity of @p ready.
+ * @param timeout_ms Timeout in milliseconds (OS_WAIT_FOREVER for blocking).
+ * @return Number of entries written to @p ready (0 on timeout), negative on error.
+ */
+int os_poller_wait(os_poller_t p, void** ready, int max, uint32_t timeout_ms);
+
+
+/* ---------- Pollable Timers ---------- */
+
+/** Pollable one-shot timer handle type */
+typedef struct os_timer* os_timer_t;
+
+
+/**
+ * @brief Create a disarmed one-shot timer that can be watched by a poller.
+ *
+ * @return Timer handle on success, NULL on failure or if unsupported.
+ */
+os_timer_t os_timer_create(void);
+
+
+/**
+ * @brief Descriptor that becomes readable when the timer expires.
+ *
+ * @param t Timer handle.
+ * @return Descriptor for os_poller_add().
+ */
+int os_timer_fd(os_timer_t t);
+
+
+/**
+ * @brief Arm the timer for an absolute deadline, replacing any previous one.
+ *
+ * @param t Timer handle.
+ * @param deadline_ms Deadline on the os_time_ms() clock, 0 to disarm.
+ */
+void os_timer_arm(os_timer_t t, uint64_t deadline_ms);
+
+
+/**
+ * @brief Acknowledge an expiration so the descriptor is no longer readable.
+ *
+ * @param t Timer handle.
+ */
+void os_timer_ack(os_timer_t t);
+
+
+/* ---------- Pollable Events ---------- */
+
+/** Pollable event handle type */
+typedef struct os_event* os_event_t;
+
+
+/**
+ * @brief Create an event that can be watched by a poller (or any event loop).
+ *
+ * @return Event handle on success, NULL on failure or if unsupported.
+ */
+os_event_t os_event_create(void);
+
+
+/**
+ * @brief Descriptor that is readable while the event is signalled.
+ *
+ * @param e Event handle.
+ * @return Descriptor for os_poller_add(), epoll, libuv, etc.
+ */
+int os_event_fd(os_event_t e);
+
+
+/**
+ * @brief Signal the event (wakes pollers of its descriptor). Thread-safe.
+ *
+ * @param e Event handle.
+ */
+void os_event_signal(os_event_t e);
+
+
+/**
+ * @brief Reset the event so its descriptor is no longer readable.
+ *
+ * @param e Event handle.
+ */
+void os_event_clear(os_event_t e);
+
+
+/* ---------- Timer Wheel ---------- */
+
+/** Timer wheel handle type */
+typedef struct os_twheel* os_twheel_t;
+
+/** Timer expiry callback */
+typedef void (*os_wtimer_fn)(void* arg);
+
+/**
+ * @brief Timer served by a timer wheel.
+ *
+ * Owned and embedded by the caller (e.g. in a request waiter), so starting
+ * and cancelling need no allocation. Members are private to the OSAL.
+ */
+typedef struct os_wtimer {
+    struct os_wtimer* next;   /**< Next timer in the same list */
+    struct os_wtimer** pprev; /**< Link pointing at this timer, NULL when idle */
+    uint64_t expires;         /**< Expiry tick */
+    os_wtimer_fn fn;          /**< Callback */
+    void* arg;                /**< Callback argument */
+    uint8_t level;            /**< Wheel level holding the timer */
+    uint8_t slot;             /**< Slot within that level */
+} os_wtimer_t;
+
+
+/**
+ * @brief Create a hierarchical timer wheel.
+ *
+ * Starting and cancelling a timer is O(1) regardless of how many are
+ * pending. The wheel is driven either by polling os_twheel_fd() and
+ * calling os_twheel_dispatch(), or by a thread running os_twheel_run().
+ *
+ * @param tick_ms Resolution in milliseconds; timers never fire early.
+ * @return Wheel handle on success, NULL on failure.
+ */
+os_twheel_t os_twheel_create(uint32_t tick_ms);
+
+
+/**
+ * @brief Name a timer wheel and include its lock in os_mutex_list_stats().
+ *
+ * @param w Wheel handle.
+ * @param name Name (static string, must outlive the wheel).
+ */
+void os_twheel_set_name(os_twheel_t w, const char* name);
+
+
+/**
+ * @brief Descriptor that becomes readable when timers are due.
+ *
+ * @param w Wheel handle.
+ * @return Descriptor for os_poller_add().
+ */
+int os_twheel_fd(os_twheel_t w);
+
+
+/**
+ * @brief Run the callbacks of all due timers.
+ *
+ * Callbacks run in the calling thread, one at a time and without wheel
+ * locks held, so they may start or cancel timers.
+ *
+ * @param w Wheel handle.
+ */
+void os_twheel_dispatch(os_twheel_t w);
+
+
+/**
+ * @brief Drive the wheel from the calling thread; never returns.
+ *
+ * @param w Wheel handle.
+ */
+void os_twheel_run(os_twheel_t w);
+
+
+/**
+ * @brief Prepare a timer before its first use.
+ *
+ * @param t Timer.
+ * @param fn Callback run on expiry.
+ * @param arg Callback argument.
+ */
+void os_wtimer_init(os_wtimer_t* t, os_wtimer_fn fn, void* arg);
+
+
+/**
+ * @brief Start a timer, or move it if already pending.
+ *
+ * @param w Wheel handle.
+ * @param t Timer (initialized with os_wtimer_init()).
+ * @param deadline_ms Deadline on the os_time_ms() clock.
+ */
+void os_wtimer_start(os_twheel_t w, os_wtimer_t* t, uint64_t deadline_ms);
+
+
+/**
+ * @brief Cancel a timer.
+ *
+ * If the callback is running in another thread, waits for it to return,
+ * so the timer and its argument may be reused or freed afterwards.
+ * Must not be called with a lock the callback takes.
+ *
+ * @param w Wheel handle.
+ * @param t Timer.
+ * @return true if the timer was pending (its callback will not run),
+ *         false if it already fired or was never started.
+ */
+bool os_wtimer_cancel(os_twheel_t w, os_wtimer_t* t);
+
+
+/* ---------- Memory Arena ---------- */
+
+/** Back the arena with huge pages when the system has them */
+#define OS_ARENA_HUGEPAGES  0x1u
+
+/** Lock all process memory (current and future) when the arena is sealed */
+#define OS_ARENA_MLOCK      0x2u
+
+
+/** OSAL object kinds, for sizing an arena */
+typedef enum {
+    OS_OBJ_THREAD,  /**< os_thread_create() / os_thread_create_ex() */
+    OS_OBJ_SEM,     /**< os_sem_create_binary() */
+    OS_OBJ_MUTEX,   /**< os_mutex_create() / os_mutex_create_pi() */
+    OS_OBJ_QUEUE,   /**< Any queue flavour */
+    OS_OBJ_POLLER,  /**< os_poller_create() */
+    OS_OBJ_TIMER,   /**< os_timer_create() */
+    OS_OBJ_EVENT,   /**< os_event_create() */
+    OS_OBJ_TWHEEL,  /**< os_twheel_create() */
+    OS_OBJ_RING,    /**< os_ring_create() */
+    OS_OBJ_MEM      /**< os_mem_alloc() */
+} os_obj_t;
+
+
+/**
+ * @brief Arena bytes needed by one OSAL object.
+ *
+ * @param kind Object kind.
+ * @param length Queue length (OS_OBJ_QUEUE), ring size in bytes (OS_OBJ_RING),
+ *               block size in bytes (OS_OBJ_MEM).
+ * @param item_size Queue item size (OS_OBJ_QUEUE only).
+ * @return Upper bound of the object's arena footprint.
+ */
+size_t os_arena_footprint(os_obj_t kind, size_t length, size_t item_size);
+
+
+/**
+ * @brief Place all further OSAL objects in one preallocated, prefaulted region.
+ *
+ * Objects are carved out cache-line aligned, one after another, instead of
+ * being scattered over the heap. Must be called before creating objects.
+ * If the arena runs out, objects fall back to the heap (logged as an error).
+ *
+ * @param size Arena size in bytes (see os_arena_footprint()).
+ * @param flags OS_ARENA_* flags.
+ * @return true on success, false if the region could not be mapped.
+ */
+bool os_arena_init(size_t size, uint32_t flags);
+
+
+/**
+ * @brief End of initialization: later object allocations are reported.
+ *
+ * Applies OS_ARENA_MLOCK. Any OSAL allocation after this call is logged
+ * as an error, so a hot path that creates objects shows up at once.
+ */
+void os_arena_seal(void);
+
+
+/**
+ * @brief Allocate a zeroed, cache-line aligned block of memory.
+ *
+ * Carved from the arena when one is set up, like OSAL objects, so tables
+ * sized at init stay next to the objects that use them.
+ *
+ * @param size Block size in bytes.
+ * @return Block, NULL if out of memory.
+ */
+void* os_mem_alloc(size_t size);
+
+
+/**
+ * @brief Release a block from os_mem_alloc() (arena blocks are never reused).
+ *
+ * @param p Block, may be NULL.
+ */
+void os_mem_free(void* p);
+
+
+/**
+ * @brief Arena bytes in use.
+ *
+ * @return Bytes handed out so far, 0 without an arena.
+ */
+size_t os_arena_used(void);
+
+
 /* ---------- Misc ---------- */
 
 /**
@@ -155,4 +854,25 @@ void os_mutex_unlock(os_mutex_t m);
  */
 void os_delay_ms(uint32_t ms);
 
+
+/**
+ * @brief Monotonic time in milliseconds.
+ *
+ * Never goes backwards and is not affected by wall-clock changes; the
+ * origin is unspecified, so only differences are meaningful.
+ *
+ * @return Current monotonic time in milliseconds.
+ */
+uint64_t os_time_ms(void);
+
+
+/**
+ * @brief Monotonic time in nanoseconds.
+ *
+ * Same clock as os_time_ms(), for measuring short intervals.
+ *
+ * @return Current monotonic time in nanoseconds.
+ */
+uint64_t os_time_ns(void);
+
 #endif /* RPC_OSAL_H_ */
@@ -55,6 +55,17 @@ int rpc_phy_send(const uint8_t *data, size_t len);
  */
 int rpc_phy_receive(uint8_t *data, size_t len);
 
+/**
+ * @brief Get a descriptor that becomes readable when received data is pending.
+ *
+ * Required only by the reactor runtime, which polls it instead of blocking
+ * in rpc_phy_receive(); once it is readable, rpc_phy_receive() must return
+ * the pending bytes without waiting for @p len bytes.
+ *
+ * @return Pollable descriptor, or a negative value if not supported.
+ */
+int rpc_phy_get_rx_fd(void);
+
 /**
  * @brief Deinitialize the physical layer.
  *
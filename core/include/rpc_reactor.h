@@ -0,0 +1,42 @@
+/**
+ * @file    rpc_reactor.h
+ * @brief   RPC single-threaded reactor runtime.
+ *
+ * Alternative to the threaded pipeline (RX, TX, transport and worker
+ * threads linked by queues): one event loop waits on the PHY receive
+ * descriptor and a timer wheel, parses frames, runs handlers and writes
+ * responses itself, so a message crosses no queue and no thread switch.
+ * Request deadlines are driven by the loop instead of a timer thread.
+ */
+
+#ifndef RPC_REACTOR_H_
+#define RPC_REACTOR_H_
+
+#include <stdint.h>
+
+#include "rpc_errors.h"
+#include "rpc_osal.h"
+
+
+// === Function Prototypes ===
+
+/**
+ * @brief Initialize the reactor runtime.
+ *
+ * Creates the poller, watches the PHY receive descriptor and the
+ * transport layer's timer wheel, and routes received frames straight
+ * to the transport layer. Must be called after the PHY and transport
+ * layers are initialized.
+ *
+ * @return RPC_SUCCESS on success, RPC_ERROR on failure.
+ */
+int rpc_reactor_init(void);
+
+/**
+ * @brief Start the reactor event loop thread.
+ *
+ * Scheduled as configured by RPC_THREAD_REACTOR_*.
+ */
+void rpc_reactor_start_thread(void);
+
+#endif /* RPC_REACTOR_H_ */
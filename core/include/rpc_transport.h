@@ -31,6 +31,12 @@
 #define MSG_RESP      0x16 /**< Response message type */
 #define MSG_ERR       0x21 /**< Error message type */
 
+/** Set in the type of a message that carries a method ID instead of the name */
+#define MSG_ID_FLAG   0x80
+
+/** Set in the type of a request that carries its caller's deadline budget */
+#define MSG_BUDGET_FLAG 0x40
+
 
 // === Function Prototypes ===
 
@@ -38,18 +44,133 @@
  * @brief Register a function in the RPC registry.
  * @param name Function name to register.
  * @param fn Function pointer.
- * @return RPC_SUCCESS on success, RPC_ERROR on failure.
+ * @return RPC_SUCCESS on success (a name already registered keeps its
+ *         first function), RPC_ERROR_INVALID_ARGS or RPC_ERROR on failure.
  */
 int register_fn(const char* name, rpc_fn_t fn);
 
 
+/**
+ * @brief Register a function served by the workers of a dispatch class.
+ * @param name Function name to register.
+ * @param fn Function pointer.
+ * @param cls Dispatch class, 0 for the default class.
+ * @return As register_fn(); RPC_ERROR_INVALID_ARGS for an unknown class.
+ */
+int register_fn_ex(const char* name, rpc_fn_t fn, uint8_t cls);
+
+
+/**
+ * @brief Create dispatch classes 1..@p count after the default class.
+ *
+ * Each class gets its own request queue; its workers start with
+ * rpc_worker_start_thread(). The reactor runtime runs every handler in
+ * its loop and only uses the classes for registration.
+ *
+ * @param classes Class configurations.
+ * @param count Number of classes, at most RPC_CLASS_MAX - 1.
+ * @return RPC_SUCCESS on success, RPC_ERROR_INVALID_ARGS for too many or
+ *         unnamed classes, RPC_ERROR if out of memory.
+ */
+int rpc_trans_set_classes(const rpc_class_cfg_t* classes, size_t count);
+
+
+/**
+ * @brief Name of the request queue of a dispatch class.
+ *
+ * With work stealing its workers' deques are named "<name>/<n>".
+ *
+ * @param cls Dispatch class.
+ * @return Queue name, NULL for an unknown class.
+ */
+const char* rpc_trans_class_queue(uint8_t cls);
+
+
+/**
+ * @brief Find a registered function by name.
+ *
+ * Lock-free: safe to call from any thread, also while functions are being
+ * registered.
+ *
+ * @param name Function name.
+ * @return Function pointer, NULL if no function has that name.
+ */
+rpc_fn_t rpc_trans_find_fn(const char* name);
+
+
+/**
+ * @brief Install the method table shared with the peer.
+ *
+ * Requests and streams for the methods in the table are sent with their
+ * ID instead of the name, and so are the answers to requests that arrived
+ * by ID; incoming messages by ID are dispatched by array index. Both peers
+ * must install the same table.
+ *
+ * @param methods Method table (static, must outlive the RPC system).
+ * @param count Number of entries.
+ * @return RPC_SUCCESS on success, RPC_ERROR_INVALID_ARGS for an invalid
+ *         table (bad or duplicate name or ID), RPC_ERROR if out of memory.
+ */
+int rpc_trans_set_methods(const rpc_method_t* methods, size_t count);
+
+
 /**
  * @brief Initialize the transport layer.
  *
  * Creates queues, waiter tables, and initializes all transport layer components.
  * Must be called before any other transport layer operations.
+ *
+ * @param runtime Runtime model the transport layer serves.
+ * @param poll_streams Deliver incoming streams through rpc_trans_poll().
+ * @param sched RPC_SCHED_SHARED or RPC_SCHED_STEAL for every dispatch class.
+ */
+void rpc_trans_init(rpc_runtime_t runtime, bool poll_streams, rpc_sched_t sched);
+
+
+/**
+ * @brief Set the default response wait strategy of synchronous requests.
+ *
+ * @param wait RPC_WAIT_PARK or RPC_WAIT_ADAPTIVE.
+ * @param spin_max_us Longest adaptive spin in microseconds.
+ */
+void rpc_trans_set_wait(rpc_wait_t wait, uint32_t spin_max_us);
+
+
+/**
+ * @brief OSAL arena bytes needed by the transport layer.
+ *
+ * Covers everything rpc_trans_init(), rpc_trans_set_classes() and the
+ * transport start functions create.
+ *
+ * @param classes Dispatch classes after the default one (may be NULL).
+ * @param class_count Number of @p classes.
+ * @param sched Scheduler mode given to rpc_trans_init().
+ * @return Footprint in bytes.
+ */
+size_t rpc_trans_arena_size(const rpc_class_cfg_t* classes, size_t class_count,
+                            rpc_sched_t sched);
+
+
+/**
+ * @brief Handle a message received by the link layer.
+ *
+ * Resolves the waiter of a response/error, or dispatches a request/stream
+ * (to the workers, or in place with the reactor runtime).
+ *
+ * @param b RX buffer holding the payload; ownership is taken.
+ */
+void rpc_trans_handle_incoming(rpc_buf_t* b);
+
+
+/**
+ * @brief Timer wheel serving request and handler deadlines.
+ *
+ * Driven by the timer thread (threaded runtime) or the event loop
+ * (reactor runtime).
+ *
+ * @return Wheel handle.
  */
-void rpc_trans_init(void);
+os_twheel_t rpc_trans_timers(void);
 
 
 /**
@@ -63,12 +184,143 @@ void rpc_trans_init(void);
  * @param resp_buf Response buffer.
  * @param resp_len Response length (input: capacity, output: actual length).
  * @param timeout_ms Timeout in milliseconds.
+ * @param opts Call options, NULL for the defaults.
  * @return RPC_SUCCESS on success, error code on failure.
  */
 int rpc_trans_request(const char* name,
 			          const void* args, uint16_t args_len,
 			          void* resp_buf, uint16_t* resp_len,
-			          uint32_t timeout_ms);
+			          uint32_t timeout_ms, const rpc_call_opts_t* opts);
+
+
+/**
+ * @brief Several remote function calls with a single wait.
+ *
+ * Sends the requests back to back and blocks once, until all of them
+ * are resolved (response, error or the common deadline).
+ *
+ * @param e Calls; @c rc and @c resp_len are written back.
+ * @param n Number of calls, at most RPC_BATCH_MAX and the waiter table size.
+ * @param timeout_ms Timeout of the whole batch in milliseconds.
+ * @return RPC_SUCCESS if every call succeeded, otherwise the result of the
+ *         first failed one (RPC_ERROR_INVALID_ARGS for a bad batch).
+ */
+int rpc_trans_request_batch(rpc_batch_entry_t* e, size_t n, uint32_t timeout_ms);
+
+
+/**
+ * @brief Asynchronous remote function call.
+ *
+ * Sends a request without waiting; the response, error or timeout is
+ * reported to @p done by the executor (rpc_trans_set_executor()), or from
+ * rpc_trans_poll() without one.
+ *
+ * @param name Function name to call.
+ * @param args Arguments buffer.
+ * @param args_len Arguments length.
+ * @param timeout_ms Timeout in milliseconds.
+ * @param done Completion callback.
+ * @param user Argument of @p done.
+ * @return RPC_SUCCESS if sent, RPC_ERROR_BUSY if no waiter is free (never
+ *         waited for), other error code on failure (@p done is not called).
+ */
+int rpc_trans_request_async(const char* name,
+                            const void* args, uint16_t args_len,
+                            uint32_t timeout_ms,
+                            rpc_done_fn done, void* user);
+
+
+/**
+ * @brief Asynchronous remote function call completed through a future.
+ *
+ * @param name Function name to call.
+ * @param args Arguments buffer.
+ * @param args_len Arguments length.
+ * @param timeout_ms Timeout in milliseconds.
+ * @param out Future of the request (NULL on failure).
+ * @return RPC_SUCCESS if sent, RPC_ERROR_BUSY if no waiter is free (never
+ *         waited for), other error code on failure.
+ */
+int rpc_trans_request_future(const char* name,
+                             const void* args, uint16_t args_len,
+                             uint32_t timeout_ms, rpc_future_t* out);
+
+
+/**
+ * @brief Wait until the request of a future has its outcome.
+ *
+ * @param f Future.
+ * @param timeout_ms Longest wait.
+ * @return RPC_SUCCESS once resolved, RPC_ERROR_TIMEOUT if still pending.
+ */
+int rpc_trans_future_wait(rpc_future_t f, uint32_t timeout_ms);
+
+
+/**
+ * @brief Wait for the outcome of a future, take its response and release it.
+ *
+ * @param f Future, invalid afterwards.
+ * @param resp_buf Response buffer.
+ * @param resp_len Response length (input: capacity, output: actual length).
+ * @return Result of the request, RPC_ERROR_OVERFLOW if the response does
+ *         not fit.
+ */
+int rpc_trans_future_get(rpc_future_t f, void* resp_buf, uint16_t* resp_len);
+
+
+/**
+ * @brief Give up a future without taking its outcome.
+ *
+ * @param f Future, invalid afterwards.
+ */
+void rpc_trans_future_release(rpc_future_t f);
+
+
+/**
+ * @brief Wait until any of several futures has its outcome.
+ *
+ * @param fs Futures.
+ * @param n Number of futures.
+ * @param timeout_ms Longest wait.
+ * @return Index of a resolved future, RPC_ERROR_TIMEOUT if none resolved.
+ */
+int rpc_trans_wait_any(const rpc_future_t* fs, size_t n, uint32_t timeout_ms);
+
+
+/**
+ * @brief Wait until all of several futures have their outcome.
+ *
+ * @param fs Futures.
+ * @param n Number of futures.
+ * @param timeout_ms Longest wait for all of them.
+ * @return RPC_SUCCESS once all resolved, RPC_ERROR_TIMEOUT otherwise.
+ */
+int rpc_trans_wait_all(const rpc_future_t* fs, size_t n, uint32_t timeout_ms);
+
+
+/**
+ * @brief Set the executor running asynchronous completion callbacks.
+ *
+ * @param exec Executor, NULL (or a NULL submit) to deliver them from
+ *        rpc_trans_poll().
+ */
+void rpc_trans_set_executor(const rpc_executor_t* exec);
+
+
+/**
+ * @brief Descriptor that becomes readable when rpc_trans_poll() has work.
+ *
+ * @return File descriptor.
+ */
+int rpc_trans_poll_fd(void);
+
+
+/**
+ * @brief Run queued completion callbacks and stream handlers, without blocking.
+ *
+ * @return Number of callbacks and handlers run.
+ */
+int rpc_trans_poll(void);
 
 
 /**
@@ -83,10 +335,11 @@ int rpc_trans_stream(const char* name, const void* args, uint16_t args_len);
 
 
 /**
- * @brief Start the transport layer thread.
+ * @brief Start the transport layer threads.
  *
  * Creates and starts the thread that handles message processing
- * between link and transport layers.
+ * between link and transport layers, and the thread driving the
+ * deadline timer wheel.
  */
 void rpc_transport_start_thread(void);
 
@@ -94,10 +347,23 @@ void rpc_transport_start_thread(void);
 /**
  * @brief Start RPC worker threads.
  *
- * Creates and starts multiple worker threads for parallel
- * request processing.
+ * Creates and starts the worker threads of every dispatch class: the
+ * minimum of an elastic class, which then grows and shrinks with the load.
+ *
+ * @param elastic Whether workers may be started (and retired) later; if
+ *        not, elastic classes start their maximum and keep it.
+ */
+void rpc_worker_start_thread(bool elastic);
+
+
+/**
+ * @brief Worker pool statistics of a dispatch class.
+ *
+ * @param cls Dispatch class.
+ * @param out Output snapshot.
+ * @return RPC_SUCCESS on success, RPC_ERROR for an unknown class.
  */
-void rpc_worker_start_thread(void);
+int rpc_trans_pool_stats(uint8_t cls, rpc_pool_stats_t* out);
 
 
 #endif /* RPC_TRANSPORT_H_ */
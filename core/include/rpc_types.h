@@ -2,6 +2,7 @@
 #define RPC_TYPES_H_
 
 #include <stdint.h>
+#include "rpc_osal.h"
 
 /**
  * @brief Type of handler function for registered RPC methods.
@@ -11,7 +12,8 @@
  * @param out_buf   Output buffer for response data.
  * @param out_cap   Capacity of @p out_buf.
  * @param out_len   Pointer to store actual response length.
- * @param timeout_ms Timeout for processing (in milliseconds).
+ * @param timeout_ms Time left for processing (in milliseconds): the caller's
+ *                   remaining deadline, at most HANDLER_TIMEOUT_MS_DEFAULT.
  *
  * @return RPC_SUCCESS on success, or an error code (<0).
  */
@@ -19,4 +21,128 @@ typedef int (*rpc_fn_t)(const uint8_t* args, uint16_t alen,
                         uint8_t* out, uint16_t out_capacity,
                         uint16_t* out_len, uint32_t timeout_ms);
 
+/**
+ * @brief Completion callback of an asynchronous request.
+ *
+ * @param rc        RPC_SUCCESS, or an error code (<0) such as RPC_ERROR_TIMEOUT.
+ * @param resp      Response data, valid only during the callback.
+ * @param resp_len  Length of the response data (0 on error).
+ * @param user      Pointer given when the request was issued.
+ */
+typedef void (*rpc_done_fn)(int rc, const uint8_t* resp, uint16_t resp_len, void* user);
+
+/**
+ * @brief Unit of work handed to an executor.
+ *
+ * @param arg       Argument given with the task.
+ */
+typedef void (*rpc_task_fn)(void* arg);
+
+/**
+ * @brief Executor running the completion callbacks of asynchronous requests.
+ *
+ * @c submit is called in the thread that resolved the request (transport
+ * or timer thread, or the reactor loop); it must not block and must run
+ * @p task(@p arg) exactly once, in any thread. A NULL @c submit delivers
+ * the callbacks from rpc_poll().
+ */
+typedef struct {
+    void (*submit)(rpc_task_fn task, void* arg, void* ctx); /**< Hand over a task */
+    void* ctx;                                               /**< Passed to @c submit */
+} rpc_executor_t;
+
+/**
+ * @brief Handle of an asynchronous request whose outcome is waited for
+ *        (see rpc_request_future()).
+ */
+typedef struct rpc_future* rpc_future_t;
+
+/**
+ * @brief One call of rpc_request_batch().
+ */
+typedef struct {
+    const char* name;      /**< Function name */
+    const void* args;      /**< Arguments (may be NULL) */
+    uint16_t args_len;     /**< Length of @c args */
+    void* resp_buf;        /**< Response buffer */
+    uint16_t resp_len;     /**< In: capacity of @c resp_buf. Out: response length */
+    int rc;                /**< Out: result of the call */
+} rpc_batch_entry_t;
+
+/**
+ * @brief Entry of the method table shared by both peers (see rpc_init_cfg_t).
+ */
+typedef struct {
+    const char* name;   /**< Function name */
+    uint16_t id;        /**< Method ID sent in place of the name, 1..RPC_METHOD_ID_MAX-1 */
+} rpc_method_t;
+
+/**
+ * @brief How the workers of a dispatch class share its requests.
+ */
+typedef enum {
+    RPC_SCHED_DEFAULT, /**< Mode chosen by RPC_SCHED_MODE_DEFAULT */
+    RPC_SCHED_SHARED,  /**< One queue per class, all its workers take from it */
+    RPC_SCHED_STEAL    /**< One deque per worker, idle workers steal from busy ones */
+} rpc_sched_t;
+
+/**
+ * @brief Dispatch class: a request queue with its own worker threads
+ *        (see rpc_register_ex()).
+ *
+ * Zero @c workers and @c queue_depth take 1 and Q_RPC_REQUEST_DEPTH. With
+ * @c max_workers above @c workers the pool is elastic: it starts with
+ * @c workers threads, grows when requests back up and shrinks back when
+ * workers idle (see RPC_POOL_GROW_DEPTH in rpc_config.h).
+ */
+typedef struct {
+    const char* name;          /**< Class name; its queue is "rpc_requests.<name>" */
+    uint8_t workers;           /**< Worker threads serving the class (minimum of an elastic pool) */
+    uint8_t max_workers;       /**< Most worker threads, 0 for a fixed pool of @c workers */
+    uint16_t queue_depth;      /**< Requests the class's queue holds */
+    os_sched_policy_t policy;  /**< Scheduling policy of the workers */
+    uint8_t priority;          /**< Real-time priority of the workers */
+    uint64_t cpu_mask;         /**< Allowed CPUs of the workers, 0 for any */
+} rpc_class_cfg_t;
+
+/**
+ * @brief Worker pool statistics of a dispatch class (see rpc_stats_pool()).
+ */
+typedef struct {
+    uint8_t workers;       /**< Worker threads running now */
+    uint8_t min_workers;   /**< Threads the pool keeps when idle */
+    uint8_t max_workers;   /**< Most threads the pool may run */
+    uint8_t high_water;    /**< Most threads run at once */
+    uint64_t spawned;      /**< Workers started beyond the minimum */
+    uint64_t retired;      /**< Workers that exited after idling RPC_POOL_LINGER_MS */
+    uint64_t expired;      /**< Requests shed unhandled: their caller's deadline had passed */
+} rpc_pool_stats_t;
+
+/**
+ * @brief Runtime models selectable at rpc_init_ex().
+ */
+typedef enum {
+    RPC_RUNTIME_THREADED, /**< RX, TX, transport and worker threads linked by queues */
+    RPC_RUNTIME_REACTOR   /**< One event loop doing PHY I/O, parsing and dispatch */
+} rpc_runtime_t;
+
+/**
+ * @brief How a synchronous request waits for its response.
+ */
+typedef enum {
+    RPC_WAIT_DEFAULT,  /**< Strategy chosen at rpc_init_ex() (per call), RPC_WAIT_MODE_DEFAULT (at init) */
+    RPC_WAIT_PARK,     /**< Sleep until the response arrives */
+    RPC_WAIT_ADAPTIVE  /**< Spin for about the method's learned round trip, then sleep */
+} rpc_wait_t;
+
+/**
+ * @brief Per-call options of rpc_request_ex().
+ *
+ * Zero-initialized fields take the values given to rpc_init_ex().
+ */
+typedef struct {
+    rpc_wait_t wait;       /**< Wait strategy */
+    uint32_t spin_max_us;  /**< Longest spin of RPC_WAIT_ADAPTIVE in microseconds */
+} rpc_call_opts_t;
+
 #endif /* RPC_TYPES_H_ */
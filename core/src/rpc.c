@@ -5,6 +5,7 @@
  * This file contains the top-level functions of the RPC framework.
  * Most of the work is delegated to the lower layers:
  *  - transport (rpc_transport.c)
+ *  - reactor runtime (rpc_reactor.c)
  *  - link (rpc_link.c)
  *  - physical I/O (rpc_phy.c)
  */
@@ -12,27 +13,100 @@
 #include "rpc.h"
 #include "rpc_log.h"
 #include "rpc_transport.h"
+#include "rpc_reactor.h"
+
+
+static rpc_runtime_t s_runtime; /**< Runtime selected at init */
+static bool s_arena;            /**< OSAL objects live in an arena */
+static size_t s_arena_size;     /**< Arena bytes reserved at rpc_init_ex() */
+
+
+/**
+ * @brief OSAL arena size for the current configuration.
+ *
+ * Sum of the layers' object footprints: buffer free lists, transport,
+ * link RX/TX threads and the reactor's poller and thread.
+ */
+static size_t rpc_arena_size(const rpc_init_cfg_t* cfg, rpc_sched_t sched) {
+	return rpc_buf_arena_size() +
+	       rpc_trans_arena_size(cfg ? cfg->classes : NULL, cfg ? cfg->class_count : 0, sched) +
+	       3 * os_arena_footprint(OS_OBJ_THREAD, 0, 0) +
+	       os_arena_footprint(OS_OBJ_POLLER, 0, 0) +
+	       RPC_ARENA_SLACK;
+}
 
 
 /**
  * @brief Initialize the RPC system.
  *
- * Sets up transport, link, physical and OS resources. Must be called before
- * rpc_start() or any other RPC operation.
+ * @copydoc rpc_init()
  */
 int rpc_init(void) {
+	return rpc_init_ex(NULL);
+}
+
+
+/**
+ * @brief Initialize the RPC system with explicit options.
+ *
+ * Sets up transport, link, physical and OS resources (plus the event loop
+ * for the reactor runtime). Must be called before rpc_start() or any other
+ * RPC operation.
+ */
+int rpc_init_ex(const rpc_init_cfg_t* cfg) {
 	int res = RPC_SUCCESS;
 
+	s_runtime = cfg ? cfg->runtime : RPC_RUNTIME_DEFAULT;
+	s_arena = cfg ? cfg->arena : RPC_ARENA_DEFAULT;
+	uint32_t arena_flags = cfg ? cfg->arena_flags : RPC_ARENA_FLAGS_DEFAULT;
+	bool poll_streams = cfg ? cfg->poll_streams : false;
+	rpc_wait_t wait = (cfg && cfg->wait != RPC_WAIT_DEFAULT) ? cfg->wait : RPC_WAIT_MODE_DEFAULT;
+	uint32_t spin_max_us = (cfg && cfg->wait_spin_max_us) ? cfg->wait_spin_max_us : RPC_WAIT_SPIN_MAX_US;
+	rpc_sched_t sched = (cfg && cfg->sched != RPC_SCHED_DEFAULT) ? cfg->sched : RPC_SCHED_MODE_DEFAULT;
+
 	RPC_LOG_INFO("===== RPC Init =====");
 	RPC_LOG_INFO("===== PRC Log level = %d =====", RPC_LOG_LEVEL);
 
-	rpc_trans_init(); // Transport Init
+	// The arena must exist before the first OSAL object is created
+	s_arena_size = rpc_arena_size(cfg, sched);
+	if (s_arena && !os_arena_init(s_arena_size, arena_flags)) {
+		RPC_LOG_ERROR("OSAL Arena Fail Init");
+		return RPC_ERROR;
+	}
+
+	res = rpc_buf_init(); // Buffer pool Init
+	if (RPC_IS_ERROR(res)) {
+		RPC_LOG_ERROR("Buffer Pool Fail Init");
+		return RPC_ERROR;
+	}
+
+	rpc_trans_init(s_runtime, poll_streams, sched); // Transport Init
+	rpc_trans_set_wait(wait, spin_max_us);
+	rpc_trans_set_executor(cfg ? &cfg->executor : NULL);
+	if (cfg && cfg->class_count &&
+	    RPC_IS_ERROR(rpc_trans_set_classes(cfg->classes, cfg->class_count))) {
+		RPC_LOG_ERROR("Dispatch Classes Fail Init");
+		return RPC_ERROR;
+	}
+	if (cfg && cfg->method_count &&
+	    RPC_IS_ERROR(rpc_trans_set_methods(cfg->methods, cfg->method_count))) {
+		RPC_LOG_ERROR("Method Table Fail Init");
+		return RPC_ERROR;
+	}
 	rpc_link_init(); // Link Init
 	res = rpc_phy_init(); // PHY Init
 
 	if (RPC_IS_ERROR(res)) {
 		RPC_LOG_ERROR("PHY Level Fail Init");
-		res =  RPC_ERROR;
+		return RPC_ERROR;
+	}
+
+	if (s_runtime == RPC_RUNTIME_REACTOR) {
+		res = rpc_reactor_init(); // Event loop Init
+		if (RPC_IS_ERROR(res)) {
+			RPC_LOG_ERROR("Reactor Fail Init");
+			return RPC_ERROR;
+		}
 	}
 
 	return res;
@@ -41,14 +115,24 @@ int rpc_init(void) {
 /**
  * @brief Start RPC threads/tasks.
  *
- * Launches worker threads that process incoming RPC requests.
+ * Launches the RX, TX, transport and worker threads, or the single event
+ * loop thread of the reactor runtime. In arena mode the arena is sealed
+ * afterwards: OSAL allocations from here on are reported as errors.
  * After calling this function, the RPC system is ready for use.
  */
 void rpc_start(void) {
-	rpc_transport_start_thread();
-	rpc_worker_start_thread();
-	rpc_rx_start_thread();
-	rpc_tx_start_thread();
+	if (s_runtime == RPC_RUNTIME_REACTOR) {
+		rpc_reactor_start_thread();
+	} else {
+		rpc_transport_start_thread();
+		rpc_worker_start_thread(!s_arena); // No threads may be created once sealed
+		rpc_rx_start_thread();
+		rpc_tx_start_thread();
+	}
+	if (s_arena) {
+		RPC_LOG_INFO("OSAL arena: %zu of %zu bytes used", os_arena_used(), s_arena_size);
+		os_arena_seal();
+	}
 	os_delay_ms(1000);
 }
 
@@ -60,10 +144,21 @@ void rpc_start(void) {
  * After calling this function, the RPC system is ready for use.
  */
 int rpc_register(const char* name, rpc_fn_t fn)
+{
+	return rpc_register_ex(name, fn, 0);
+}
+
+
+/**
+ * @brief Register a function served by the workers of a dispatch class.
+ *
+ * @copydoc rpc_register_ex()
+ */
+int rpc_register_ex(const char* name, rpc_fn_t fn, uint8_t dispatch_class)
 {
 	int res;
 
-	res = register_fn(name, fn);
+	res = register_fn_ex(name, fn, dispatch_class);
 
 	if (RPC_IS_ERROR(res)) {
 		RPC_LOG_ERROR("Function registration error: %s", name);
@@ -83,7 +178,133 @@ int rpc_register(const char* name, rpc_fn_t fn)
 int rpc_request(const char* name, const void* args, uint16_t args_len,
 			    void* resp_buf, uint16_t* resp_len, uint32_t timeout_ms) {
 	return rpc_trans_request(name, args, args_len,
-			                 resp_buf, resp_len, timeout_ms);
+			                 resp_buf, resp_len, timeout_ms, NULL);
+}
+
+
+/**
+ * @brief Perform a synchronous RPC request with per-call options.
+ *
+ * @copydoc rpc_request_ex()
+ */
+int rpc_request_ex(const char* name, const void* args, uint16_t args_len,
+                   void* resp_buf, uint16_t* resp_len, uint32_t timeout_ms,
+                   const rpc_call_opts_t* opts) {
+	return rpc_trans_request(name, args, args_len,
+			                 resp_buf, resp_len, timeout_ms, opts);
+}
+
+
+/**
+ * @brief Perform several RPC requests with a single wait.
+ *
+ * @copydoc rpc_request_batch()
+ */
+int rpc_request_batch(rpc_batch_entry_t* entries, size_t n, uint32_t timeout_ms) {
+	return rpc_trans_request_batch(entries, n, timeout_ms);
+}
+
+
+/**
+ * @brief Perform an asynchronous RPC request with a completion callback.
+ *
+ * @copydoc rpc_request_async()
+ */
+int rpc_request_async(const char* name, const void* args, uint16_t args_len,
+                      uint32_t timeout_ms, rpc_done_fn done, void* user) {
+	return rpc_trans_request_async(name, args, args_len, timeout_ms, done, user);
+}
+
+
+/**
+ * @brief Run a completion callback in the resolving thread.
+ *
+ * @copydoc rpc_exec_inline()
+ */
+void rpc_exec_inline(rpc_task_fn task, void* arg, void* ctx) {
+	(void)ctx;
+	task(arg);
+}
+
+
+/**
+ * @brief Perform an asynchronous RPC request completed through a future.
+ *
+ * @copydoc rpc_request_future()
+ */
+int rpc_request_future(const char* name, const void* args, uint16_t args_len,
+                       uint32_t timeout_ms, rpc_future_t* out) {
+	return rpc_trans_request_future(name, args, args_len, timeout_ms, out);
+}
+
+
+/**
+ * @brief Wait for the outcome of a future.
+ *
+ * @copydoc rpc_future_wait()
+ */
+int rpc_future_wait(rpc_future_t f, uint32_t timeout_ms) {
+	return rpc_trans_future_wait(f, timeout_ms);
+}
+
+
+/**
+ * @brief Take the outcome of a future.
+ *
+ * @copydoc rpc_future_get()
+ */
+int rpc_future_get(rpc_future_t f, void* resp_buf, uint16_t* resp_len) {
+	return rpc_trans_future_get(f, resp_buf, resp_len);
+}
+
+
+/**
+ * @brief Release a future.
+ *
+ * @copydoc rpc_future_release()
+ */
+void rpc_future_release(rpc_future_t f) {
+	rpc_trans_future_release(f);
+}
+
+
+/**
+ * @brief Wait for any of several futures.
+ *
+ * @copydoc rpc_wait_any()
+ */
+int rpc_wait_any(const rpc_future_t* fs, size_t n, uint32_t timeout_ms) {
+	return rpc_trans_wait_any(fs, n, timeout_ms);
+}
+
+
+/**
+ * @brief Wait for all of several futures.
+ *
+ * @copydoc rpc_wait_all()
+ */
+int rpc_wait_all(const rpc_future_t* fs, size_t n, uint32_t timeout_ms) {
+	return rpc_trans_wait_all(fs, n, timeout_ms);
+}
+
+
+/**
+ * @brief Descriptor signalling pending rpc_poll() work.
+ *
+ * @copydoc rpc_poll_fd()
+ */
+int rpc_poll_fd(void) {
+	return rpc_trans_poll_fd();
+}
+
+
+/**
+ * @brief Deliver pending completions and streams.
+ *
+ * @copydoc rpc_poll()
+ */
+int rpc_poll(void) {
+	return rpc_trans_poll();
 }
 
 
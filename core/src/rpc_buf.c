@@ -0,0 +1,167 @@
+/**
+ * @file    rpc_buf.c
+ * @brief   Reference-counted payload buffer pool implementation.
+ *
+ * Buffers are statically allocated per pool and size class. Free buffers
+ * are kept as handles in an MPMC queue per class, so allocation and release
+ * are lock-free and an exhausted class can be waited on with a timeout.
+ */
+
+#include "rpc_buf.h"
+#include "rpc_link.h"
+
+
+// === Size Classes ===
+
+/** Size classes of every pool */
+enum {
+	CLS_SMALL,   /**< RPC_BUF_SMALL_SIZE payload bytes */
+	CLS_LARGE,   /**< MAX_PAYLOAD_SIZE payload bytes */
+	CLS_COUNT    /**< Number of size classes */
+};
+
+/** Small buffer storage: handle + link headroom + payload + link tailroom */
+typedef struct {
+	rpc_buf_t hdr;
+	uint8_t room[LINK_HEADROOM + RPC_BUF_SMALL_SIZE + LINK_TAILROOM];
+} small_slot_t;
+
+/** Full-size buffer storage: handle + link headroom + payload + link tailroom */
+typedef struct {
+	rpc_buf_t hdr;
+	uint8_t room[LINK_HEADROOM + MAX_PAYLOAD_SIZE + LINK_TAILROOM];
+} large_slot_t;
+
+static small_slot_t s_small[RPC_BUF_POOL_COUNT][RPC_BUF_SMALL_COUNT]; /**< Small buffers */
+static large_slot_t s_large[RPC_BUF_POOL_COUNT][RPC_BUF_LARGE_COUNT]; /**< Full-size buffers */
+
+static os_queue_t s_free[RPC_BUF_POOL_COUNT][CLS_COUNT]; /**< Free lists (buffer handles) */
+
+/** Payload capacity per size class */
+static const uint16_t s_cls_cap[CLS_COUNT] = { RPC_BUF_SMALL_SIZE, MAX_PAYLOAD_SIZE };
+
+
+// === Helper Functions ===
+
+/**
+ * @brief Prepare a buffer handle and put it on its class free list.
+ *
+ * @param b Buffer handle.
+ * @param pool Owning pool.
+ * @param cls Owning size class.
+ * @param room Start of the buffer storage behind the handle.
+ * @return RPC_SUCCESS on success, RPC_ERROR otherwise.
+ */
+static int rpc_buf_setup(rpc_buf_t* b, uint8_t pool, uint8_t cls, uint8_t* room)
+{
+	atomic_init(&b->refs, 0);
+	b->pool = pool;
+	b->cls  = cls;
+	b->cap  = s_cls_cap[cls];
+	b->len  = 0;
+	b->data = room + LINK_HEADROOM;
+
+	return (os_queue_send(s_free[pool][cls], &b, OS_NO_WAIT) == OS_TRUE) ? RPC_SUCCESS : RPC_ERROR;
+}
+
+
+// === API ===
+
+/**
+ * @brief Initialize the buffer pools.
+ *
+ * Creates the free lists and fills them with every statically allocated buffer.
+ */
+int rpc_buf_init(void)
+{
+	// Named so pool occupancy shows in the queue statistics (depth = idle buffers)
+	static const char* const names[RPC_BUF_POOL_COUNT][CLS_COUNT] = {
+		[RPC_BUF_POOL_RX] = { "buf_rx_small", "buf_rx_large" },
+	};
+
+	for (uint8_t p = 0; p < RPC_BUF_POOL_COUNT; p++) {
+		s_free[p][CLS_SMALL] = os_mpmc_queue_create(RPC_BUF_SMALL_COUNT, sizeof(rpc_buf_t*));
+		s_free[p][CLS_LARGE] = os_mpmc_queue_create(RPC_BUF_LARGE_COUNT, sizeof(rpc_buf_t*));
+		if (!s_free[p][CLS_SMALL] || !s_free[p][CLS_LARGE]) {
+			RPC_LOG_ERROR("Failed to create buffer free lists");
+			return RPC_ERROR;
+		}
+		os_queue_set_name(s_free[p][CLS_SMALL], names[p][CLS_SMALL]);
+		os_queue_set_name(s_free[p][CLS_LARGE], names[p][CLS_LARGE]);
+
+		for (size_t i = 0; i < RPC_BUF_SMALL_COUNT; i++) {
+			if (rpc_buf_setup(&s_small[p][i].hdr, p, CLS_SMALL, s_small[p][i].room) != RPC_SUCCESS)
+				return RPC_ERROR;
+		}
+		for (size_t i = 0; i < RPC_BUF_LARGE_COUNT; i++) {
+			if (rpc_buf_setup(&s_large[p][i].hdr, p, CLS_LARGE, s_large[p][i].room) != RPC_SUCCESS)
+				return RPC_ERROR;
+		}
+	}
+
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief OSAL arena bytes needed by rpc_buf_init().
+ */
+size_t rpc_buf_arena_size(void)
+{
+	return RPC_BUF_POOL_COUNT *
+	       (os_arena_footprint(OS_OBJ_QUEUE, RPC_BUF_SMALL_COUNT, sizeof(rpc_buf_t*)) +
+	        os_arena_footprint(OS_OBJ_QUEUE, RPC_BUF_LARGE_COUNT, sizeof(rpc_buf_t*)));
+}
+
+
+/**
+ * @brief Allocate a buffer able to hold @p len payload bytes.
+ */
+rpc_buf_t* rpc_buf_alloc(rpc_buf_pool_t pool, size_t len, uint32_t timeout_ms)
+{
+	if (pool >= RPC_BUF_POOL_COUNT || len > MAX_PAYLOAD_SIZE) return NULL;
+
+	int first = (len <= RPC_BUF_SMALL_SIZE) ? CLS_SMALL : CLS_LARGE;
+	rpc_buf_t* b = NULL;
+
+	// Smallest fitting class first, then anything larger that is free
+	for (int c = first; c < CLS_COUNT && !b; c++) {
+		if (os_queue_recv(s_free[pool][c], &b, OS_NO_WAIT) != OS_TRUE) b = NULL;
+	}
+
+	// Everything is in flight: wait for the fitting class to be replenished
+	if (!b && timeout_ms != OS_NO_WAIT) {
+		if (os_queue_recv(s_free[pool][first], &b, timeout_ms) != OS_TRUE) b = NULL;
+	}
+
+	if (!b) {
+		RPC_LOG_ERROR("Buffer pool %d exhausted, len: %zu", (int)pool, len);
+		return NULL;
+	}
+
+	atomic_store_explicit(&b->refs, 1, memory_order_relaxed);
+	b->len = 0;
+	return b;
+}
+
+
+/**
+ * @brief Take an additional reference to a buffer.
+ */
+void rpc_buf_ref(rpc_buf_t* b)
+{
+	atomic_fetch_add_explicit(&b->refs, 1, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Drop a reference; the last one returns the buffer to its pool.
+ */
+void rpc_buf_release(rpc_buf_t* b)
+{
+	if (!b) return;
+
+	if (atomic_fetch_sub_explicit(&b->refs, 1, memory_order_acq_rel) == 1) {
+		os_queue_send(s_free[b->pool][b->cls], &b, OS_NO_WAIT);
+	}
+}
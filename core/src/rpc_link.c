@@ -27,7 +27,8 @@ typedef enum {
 	ST_WAIT_SOD,     /**< Waiting for Start Of Data */
 	ST_READ_PAYLOAD, /**< Reading payload data */
 	ST_READ_PKTCRC,   /**< Reading packet CRC */
-	ST_WAIT_EOF      /**< Waiting for End Of Frame */
+	ST_WAIT_EOF,     /**< Waiting for End Of Frame */
+	ST_SKIP_FRAME    /**< Discarding the rest of a frame with no RX buffer */
 } st_t;
 
 
@@ -39,9 +40,12 @@ static struct {
 	uint16_t length;                    /**< Packet length from SOD to EOF */
 	uint8_t hdr[3];                     /**< Header buffer: SOF + len_l + len_h */
 	size_t payload_pos;                 /**< Current payload position */
-	uint8_t payload[MAX_PAYLOAD_SIZE];  /**< Payload buffer */
+	uint8_t* data;                      /**< Payload destination (ring record or buffer data) */
+	rpc_buf_t* buf;                     /**< RX pool buffer receiving the payload (rx handler only) */
 } P;
 
+static rpc_link_rx_fn s_rx_handler; /**< Direct frame consumer, NULL to use qLinkToTrans */
+
 
 /**
  * @brief Initialize the link layer parser.
@@ -55,6 +59,15 @@ void rpc_link_init(void)
 }
 
 
+/**
+ * @brief Deliver received frames to a function instead of qLinkToTrans.
+ */
+void rpc_link_set_rx_handler(rpc_link_rx_fn fn)
+{
+	s_rx_handler = fn;
+}
+
+
 /**
  * @brief Reset the parser to initial state.
  *
@@ -62,6 +75,11 @@ void rpc_link_init(void)
  */
 static void rpc_link_reset_parser(void)
 {
+	// Drop a partially received payload
+	if (P.buf) rpc_buf_release(P.buf);
+	else if (P.data) os_ring_commit(qLinkToTrans, P.data, 0);
+	P.buf = NULL;
+	P.data = NULL;
 	P.st = ST_WAIT_SOF;
 	P.payload_pos = 0;
 	P.length = 0;
@@ -71,9 +89,10 @@ static void rpc_link_reset_parser(void)
 /**
  * @brief Feed bytes to the link layer parser state machine.
  *
- * Processes incoming bytes through the state machine. When a complete
- * frame is successfully assembled, it sends the payload to the
- * qLinkToTrans queue.
+ * Processes incoming bytes through the state machine. The payload is
+ * written straight into a qLinkToTrans ring record, committed when a
+ * complete frame is successfully assembled (or into an RX pool buffer
+ * handed to the handler set by rpc_link_set_rx_handler()).
  *
  * @param d Pointer to raw byte data.
  * @param n Number of bytes to process.
@@ -126,6 +145,23 @@ void rpc_link_feed_bytes(const uint8_t* d, size_t n)
 				break;
 			case ST_WAIT_SOD:
 				if (b == SOD) {
+					// Payload size is known now: take exactly the room it needs
+					size_t plen = (size_t)(P.length - 3);
+					if (s_rx_handler) {
+						// The handler's thread also returns buffers (and runs the
+						// timers): it must not wait for one, the frame is dropped
+						P.buf = rpc_buf_alloc(RPC_BUF_POOL_RX, plen, OS_NO_WAIT);
+						P.data = P.buf ? P.buf->data : NULL;
+					} else {
+						P.data = os_ring_reserve(qLinkToTrans, plen, OS_WAIT_FOREVER);
+					}
+					if (!P.data) {
+						RPC_LOG_ERROR("No RX buffer for payload of %zu bytes, frame dropped", plen);
+						// Skip payload, CRC and EOF rather than hunt for SOF in them
+						P.payload_pos = 0;
+						P.st = ST_SKIP_FRAME;
+						break;
+					}
 					P.payload_pos = 0;
 					P.st = ST_READ_PAYLOAD;
 				} else {
@@ -134,10 +170,10 @@ void rpc_link_feed_bytes(const uint8_t* d, size_t n)
 				}
 				break;
 			case ST_READ_PAYLOAD:
-				if (P.payload_pos < MAX_PAYLOAD_SIZE && P.payload_pos < (size_t)(P.length - 3)) {
+				if (P.payload_pos < (size_t)(P.length - 3)) {
 					// length includes: [SOD] payload[...] [pkt_crc8] [EOF]
 					// We only read the payload, the last 2 bytes will go to the next states
-					P.payload[P.payload_pos++] = b;
+					P.data[P.payload_pos++] = b;
 
 					// If you have already typed the whole body (payload_len == length-3),
 					// then we wait for pkt_crc
@@ -151,11 +187,10 @@ void rpc_link_feed_bytes(const uint8_t* d, size_t n)
 				}
 				break;
 			case ST_READ_PKTCRC: {
-				// Calculate the CRC of the packet by [SOD + payload]
-				uint8_t tmp[MAX_PAYLOAD_SIZE + 1];
-				tmp[0] = SOD;
-				memcpy(&tmp[1], P.payload, P.payload_pos);
-				uint8_t pkt_crc = crc8_compute(tmp, P.payload_pos + 1, CRC8_INIT, CRC8_POLY);
+				// Calculate the CRC of the packet by [SOD + payload], continuing from SOD
+				const uint8_t sod = SOD;
+				uint8_t pkt_crc = crc8_compute(&sod, SOD_SIZE, CRC8_INIT, CRC8_POLY);
+				pkt_crc = crc8_compute(P.data, P.payload_pos, pkt_crc, CRC8_POLY);
 				if (pkt_crc != b) {
 					RPC_LOG_ERROR("Packet CRC mismatch! Expected: 0x%02X, Got: 0x%02X", pkt_crc, b);
 					rpc_link_reset_parser();
@@ -167,22 +202,63 @@ void rpc_link_feed_bytes(const uint8_t* d, size_t n)
 			case ST_WAIT_EOF:
 				if (b == EOF_) {
 					RPC_LOG_INFO("Frame received successfully, payload size: %zu bytes", P.payload_pos);
-					link_payload_t lp;
-					lp.payload_len = P.payload_pos;
-					memcpy(lp.payload, P.payload, lp.payload_len);
-					if (os_queue_send(qLinkToTrans, &lp, OS_WAIT_FOREVER) != OS_TRUE) {
-						RPC_LOG_ERROR("Failed to send payload to transport queue");
+					if (P.buf) {
+						rpc_buf_t* b = P.buf;
+						b->len = (uint16_t)P.payload_pos;
+						P.buf = NULL; // ownership passed to the handler
+						P.data = NULL;
+						s_rx_handler(b);
+					} else {
+						os_ring_commit(qLinkToTrans, P.data, P.payload_pos);
+						P.data = NULL; // record passed to the transport layer
 					}
 				} else {
 					 RPC_LOG_ERROR("Expected EOF (0x%02X), got: 0x%02X", EOF_, b);
 				}
 				rpc_link_reset_parser();
 				break;
+			case ST_SKIP_FRAME:
+				// length includes: [SOD] payload[...] [pkt_crc8] [EOF], SOD already read
+				if (++P.payload_pos >= (size_t)(P.length - SOD_SIZE))
+					rpc_link_reset_parser();
+				break;
 			}
 	}
 }
 
 
+/**
+ * @brief Wrap a payload with link framing in place.
+ *
+ * @param frame Frame start; the payload must already be at frame + LINK_HEADROOM,
+ *              and LINK_TAILROOM bytes must be writable after it.
+ * @param len Length of payload data.
+ * @return Total frame length.
+ */
+static size_t rpc_link_frame_in_place(uint8_t* frame, size_t len)
+{
+	size_t pos = 0;
+
+	frame[pos++] = SOF;
+	// length = SOD + payload(len) + pkt_crc + EOF => len + 3
+	uint16_t L = (uint16_t)(len + 3);
+	frame[pos++] = (uint8_t)(L & 0xFF);
+	frame[pos++] = (uint8_t)(L >> 8);
+
+	uint8_t hdr_crc = crc8_compute(frame, 3, CRC8_INIT, CRC8_POLY);
+	frame[pos++] = hdr_crc;
+
+	frame[pos++] = SOD;
+	pos += len; // payload is already in place
+
+	uint8_t pkt_crc = crc8_compute(&frame[4], len + 1, CRC8_INIT, CRC8_POLY); // [SOD..payload]
+	frame[pos++] = pkt_crc;
+	frame[pos++] = EOF_;
+
+	return pos;
+}
+
+
 /**
  * @brief Build a link frame from payload and send to PHY layer.
  *
@@ -205,25 +281,36 @@ int rpc_link_build_frame(const uint8_t* payload, size_t len)
 	}
 
 	uint8_t frame[HEADER_SIZE + MAX_PKT_LEN];
-	size_t pos = 0;
+	memcpy(&frame[LINK_HEADROOM], payload, len);
+	size_t pos = rpc_link_frame_in_place(frame, len);
 
-	frame[pos++] = SOF;
-	// length = SOD + payload(len) + pkt_crc + EOF => len + 3
-	uint16_t L = (uint16_t)(len + 3);
-	frame[pos++] = (uint8_t)(L & 0xFF);
-	frame[pos++] = (uint8_t)(L >> 8);
+	int res = rpc_phy_send(frame, pos);
+	if (res < 0) {
+		RPC_LOG_ERROR("Error send frame");
+		return RPC_ERROR;
+	}
 
-	uint8_t hdr_crc = crc8_compute(frame, 3, CRC8_INIT, CRC8_POLY);
-	frame[pos++] = hdr_crc;
+	RPC_LOG_INFO("Frame sending successful");
 
-	frame[pos++] = SOD;
+	return RPC_SUCCESS;
+}
 
-	memcpy(&frame[pos], payload, len);
-	pos += len;
 
-	uint8_t pkt_crc = crc8_compute(&frame[4], len + 1, CRC8_INIT, CRC8_POLY); // [SOD..payload]
-	frame[pos++] = pkt_crc;
-	frame[pos++] = EOF_;
+/**
+ * @brief Frame a payload in place and send it to PHY layer.
+ *
+ * @param frame Frame start (headroom, payload, tailroom).
+ * @param len Length of payload data.
+ * @return RPC_SUCCESS on success, RPC_ERROR on failure.
+ */
+int rpc_link_send_frame(uint8_t* frame, size_t len)
+{
+	if (frame == NULL || len > MAX_PAYLOAD_SIZE || len < MIN_PAYLOAD_SIZE) {
+		RPC_LOG_ERROR("Invalid arguments");
+		return RPC_ERROR;
+	}
+
+	size_t pos = rpc_link_frame_in_place(frame, len);
 
 	int res = rpc_phy_send(frame, pos);
 	if (res < 0) {
@@ -273,12 +360,19 @@ static os_thread_t sThreadRX;
 /**
  * @brief Start the RX thread for link layer.
  *
- * Creates and starts the high-priority thread that handles
- * incoming data from PHY to LINK layer.
+ * Creates and starts the thread that handles incoming data from
+ * PHY to LINK layer, scheduled as configured by RPC_THREAD_RX_*.
  */
 void rpc_rx_start_thread(void)
 {
-	sThreadRX = os_thread_create("rx", ThreadRX, NULL, 1024, 2);
+	const os_thread_attr_t attr = {
+		.name       = "rx",
+		.stack_size = 1024,
+		.policy     = RPC_THREAD_RX_POLICY,
+		.priority   = RPC_THREAD_RX_PRIORITY,
+		.cpu_mask   = RPC_THREAD_RX_CPU_MASK,
+	};
+	sThreadRX = os_thread_create_ex(&attr, ThreadRX, NULL);
 }
 
 
@@ -286,9 +380,10 @@ void rpc_rx_start_thread(void)
  * @brief TX thread function (LINK → PHY).
  *
  * High priority thread that:
- * - Reads messages from transport layer queue
- * - Builds link frames using rpc_link_build_frame()
- * - Sends frames to PHY layer
+ * - Takes records from the transport-to-link ring, oldest first
+ * - Frames each in place using rpc_link_send_frame() (records carry the
+ *   link headroom and tailroom around the payload)
+ * - Sends frames to PHY layer and frees the records
  *
  * @param arg Thread argument (unused).
  * @return NULL.
@@ -296,15 +391,19 @@ void rpc_rx_start_thread(void)
 static void* ThreadTX(void* arg)
 {
 	(void)arg;
-	link_payload_t m;
+	size_t len;
 
 	RPC_LOG_INFO("TX thread started");
 
 	for (;;) {
-		if (os_queue_recv(qTransToLink, &m, OS_WAIT_FOREVER) == OS_TRUE) {
-			RPC_LOG_DEBUG("Received message from transport layer, size: %zu bytes", m.payload_len);
-			rpc_link_build_frame(m.payload, m.payload_len);
-		}
+		// Sleeps only while the ring is empty
+		uint8_t* frame = (uint8_t*)os_ring_peek(qTransToLink, &len, OS_WAIT_FOREVER);
+		if (!frame) continue;
+
+		RPC_LOG_DEBUG("Received message from transport layer, size: %zu bytes",
+		              len - LINK_HEADROOM - LINK_TAILROOM);
+		rpc_link_send_frame(frame, len - LINK_HEADROOM - LINK_TAILROOM);
+		os_ring_release(qTransToLink, frame);
 	}
 	return NULL;
 }
@@ -314,10 +413,17 @@ static os_thread_t sThreadTX;
 /**
  * @brief Start the TX thread for link layer.
  *
- * Creates and starts the high-priority thread that handles
- * outgoing data from LINK to PHY layer.
+ * Creates and starts the thread that handles outgoing data from
+ * LINK to PHY layer, scheduled as configured by RPC_THREAD_TX_*.
  */
 void rpc_tx_start_thread(void)
 {
-	sThreadTX = os_thread_create("tx", ThreadTX, NULL, 1024, 2);
+	const os_thread_attr_t attr = {
+		.name       = "tx",
+		.stack_size = 1024,
+		.policy     = RPC_THREAD_TX_POLICY,
+		.priority   = RPC_THREAD_TX_PRIORITY,
+		.cpu_mask   = RPC_THREAD_TX_CPU_MASK,
+	};
+	sThreadTX = os_thread_create_ex(&attr, ThreadTX, NULL);
 }
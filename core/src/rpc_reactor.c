@@ -0,0 +1,107 @@
+/**
+ * @file    rpc_reactor.c
+ * @brief   RPC single-threaded reactor runtime implementation.
+ *
+ * The event loop waits on two descriptors:
+ * - PHY receive: pending bytes are read in chunks and fed to the link
+ *   parser, whose frames go straight to the transport layer (responses
+ *   wake their callers, requests run their handler inline)
+ * - Timer wheel: the transport layer's deadline wheel; due request
+ *   deadlines fail their requests from the loop
+ */
+
+#include "rpc_reactor.h"
+#include "rpc_transport.h"
+
+
+static os_poller_t s_poller;    /**< Readiness poller */
+
+static int s_ev_phy;            /**< Poller context of the PHY descriptor (address used as tag) */
+static int s_ev_timer;          /**< Poller context of the timer wheel descriptor (address used as tag) */
+
+
+/**
+ * @brief Initialize the reactor runtime.
+ */
+int rpc_reactor_init(void)
+{
+	s_poller = os_poller_create();
+	if (!s_poller || !rpc_trans_timers()) {
+		RPC_LOG_ERROR("Failed to create reactor poller/timer");
+		return RPC_ERROR;
+	}
+
+	int fd = rpc_phy_get_rx_fd();
+	if (fd < 0) {
+		RPC_LOG_ERROR("PHY layer has no pollable receive descriptor");
+		return RPC_ERROR;
+	}
+
+	if (!os_poller_add(s_poller, fd, &s_ev_phy) ||
+	    !os_poller_add(s_poller, os_twheel_fd(rpc_trans_timers()), &s_ev_timer)) {
+		RPC_LOG_ERROR("Failed to watch reactor descriptors");
+		return RPC_ERROR;
+	}
+
+	// Frames are processed by the loop that parsed them
+	rpc_link_set_rx_handler(rpc_trans_handle_incoming);
+
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief Reactor event loop thread function.
+ *
+ * @param arg Thread argument (unused).
+ * @return NULL.
+ */
+static void* ThreadReactor(void* arg)
+{
+	(void)arg;
+	void* ready[2];
+	uint8_t rx[RPC_REACTOR_RX_CHUNK];
+
+	RPC_LOG_INFO("Reactor thread started");
+
+	for (;;) {
+		int n = os_poller_wait(s_poller, ready, 2, OS_WAIT_FOREVER);
+		if (n < 0) {
+			RPC_LOG_ERROR("Reactor poll failed");
+			os_delay_ms(1);
+			continue;
+		}
+
+		for (int i = 0; i < n; i++) {
+			if (ready[i] == &s_ev_phy) {
+				int res = rpc_phy_receive(rx, sizeof(rx));
+				if (res < 0) {
+					RPC_LOG_ERROR("Failed to receive data from PHY layer: error %d", res);
+					continue;
+				}
+				rpc_link_feed_bytes(rx, (size_t)res);
+			} else if (ready[i] == &s_ev_timer) {
+				os_twheel_dispatch(rpc_trans_timers());
+			}
+		}
+	}
+	return NULL;
+}
+
+
+static os_thread_t sThreadReactor;
+
+/**
+ * @brief Start the reactor event loop thread.
+ */
+void rpc_reactor_start_thread(void)
+{
+	const os_thread_attr_t attr = {
+		.name       = "reactor",
+		.stack_size = 1024,
+		.policy     = RPC_THREAD_REACTOR_POLICY,
+		.priority   = RPC_THREAD_REACTOR_PRIORITY,
+		.cpu_mask   = RPC_THREAD_REACTOR_CPU_MASK,
+	};
+	sThreadReactor = os_thread_create_ex(&attr, ThreadReactor, NULL);
+}
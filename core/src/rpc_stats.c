@@ -0,0 +1,220 @@
+/**
+ * @file    rpc_stats.c
+ * @brief   RPC runtime statistics.
+ *
+ * Collects the statistics kept by the OSAL for every named RPC queue and
+ * lock, and the transport's worker pool sizes, and renders them as
+ * tables. Counting itself happens in the OSAL (see RPC_QUEUE_STATS and
+ * RPC_MUTEX_STATS in rpc_config.h); this module only reads them.
+ */
+
+#include <string.h>
+#include "rpc.h"
+#include "rpc_config.h"
+#include "rpc_transport.h"
+
+
+/** Upper bound of the queues reported by rpc_stats_print() */
+#define RPC_STATS_MAX_QUEUES  48
+
+/** Upper bound of the locks reported by rpc_stats_print() */
+#define RPC_STATS_MAX_MUTEXES 16
+
+
+/**
+ * @brief Upper bound (us) of the histogram bucket holding quantile @p q.
+ *
+ * @return Bucket bound, 0 if there are no samples.
+ */
+static uint64_t hist_quantile_us(const os_queue_stats_t* st, double q)
+{
+	if (st->residence_samples == 0) return 0;
+
+	uint64_t target = (uint64_t)((double)st->residence_samples * q);
+	uint64_t seen = 0;
+	for (int b = 0; b < OS_QUEUE_HIST_BUCKETS; b++) {
+		seen += st->residence_hist[b];
+		if (seen > target) return 1ULL << b;
+	}
+	return 1ULL << (OS_QUEUE_HIST_BUCKETS - 1);
+}
+
+
+/**
+ * @brief Read the statistics of every RPC queue.
+ */
+size_t rpc_stats_queues(os_queue_stats_t* out, size_t max)
+{
+	return os_queue_list_stats(out, max);
+}
+
+
+/**
+ * @brief Read the statistics of one RPC queue by name.
+ */
+int rpc_stats_queue(const char* name, os_queue_stats_t* out)
+{
+	os_queue_stats_t all[RPC_STATS_MAX_QUEUES];
+
+	if (!name || !out) return RPC_ERROR;
+
+	size_t n = os_queue_list_stats(all, RPC_STATS_MAX_QUEUES);
+	if (n > RPC_STATS_MAX_QUEUES) n = RPC_STATS_MAX_QUEUES;
+	for (size_t i = 0; i < n; i++) {
+		if (all[i].name && strcmp(all[i].name, name) == 0) {
+			*out = all[i];
+			return RPC_SUCCESS;
+		}
+	}
+	return RPC_ERROR;
+}
+
+
+/**
+ * @brief Read the statistics of the request queue of a dispatch class.
+ */
+int rpc_stats_class(uint8_t dispatch_class, os_queue_stats_t* out)
+{
+	os_queue_stats_t all[RPC_STATS_MAX_QUEUES];
+	const char* name = rpc_trans_class_queue(dispatch_class);
+
+	if (!name || !out) return RPC_ERROR;
+
+	// The class queue, or the deques "<name>/<n>" of its workers
+	size_t len = strlen(name);
+	size_t n = os_queue_list_stats(all, RPC_STATS_MAX_QUEUES);
+	if (n > RPC_STATS_MAX_QUEUES) n = RPC_STATS_MAX_QUEUES;
+
+	memset(out, 0, sizeof(*out));
+	out->name = name;
+	bool found = false;
+	for (size_t i = 0; i < n; i++) {
+		const os_queue_stats_t* s = &all[i];
+		if (!s->name || strncmp(s->name, name, len) != 0 ||
+		    (s->name[len] != '\0' && s->name[len] != '/')) continue;
+
+		found = true;
+		out->capacity += s->capacity;
+		out->depth += s->depth;
+		out->high_water += s->high_water;
+		out->sent += s->sent;
+		out->received += s->received;
+		out->blocked_sends += s->blocked_sends;
+		out->blocked_send_us += s->blocked_send_us;
+		out->send_timeouts += s->send_timeouts;
+		out->recv_timeouts += s->recv_timeouts;
+		out->residence_samples += s->residence_samples;
+		out->residence_us += s->residence_us;
+		for (int b = 0; b < OS_QUEUE_HIST_BUCKETS; b++)
+			out->residence_hist[b] += s->residence_hist[b];
+	}
+	return found ? RPC_SUCCESS : RPC_ERROR;
+}
+
+
+/**
+ * @brief Read the worker pool statistics of a dispatch class.
+ */
+int rpc_stats_pool(uint8_t dispatch_class, rpc_pool_stats_t* out)
+{
+	return rpc_trans_pool_stats(dispatch_class, out);
+}
+
+
+/**
+ * @brief Read the contention statistics of every RPC lock.
+ */
+size_t rpc_stats_mutexes(os_mutex_stats_t* out, size_t max)
+{
+	return os_mutex_list_stats(out, max);
+}
+
+
+/**
+ * @brief Read the contention statistics of one RPC lock by name.
+ */
+int rpc_stats_mutex(const char* name, os_mutex_stats_t* out)
+{
+	os_mutex_stats_t all[RPC_STATS_MAX_MUTEXES];
+
+	if (!name || !out) return RPC_ERROR;
+
+	size_t n = os_mutex_list_stats(all, RPC_STATS_MAX_MUTEXES);
+	if (n > RPC_STATS_MAX_MUTEXES) n = RPC_STATS_MAX_MUTEXES;
+	for (size_t i = 0; i < n; i++) {
+		if (all[i].name && strcmp(all[i].name, name) == 0) {
+			*out = all[i];
+			return RPC_SUCCESS;
+		}
+	}
+	return RPC_ERROR;
+}
+
+
+/**
+ * @brief Print a table of all RPC statistics.
+ *
+ * Residence percentiles are histogram bucket bounds ("at most"); lock
+ * hold times are means and maxima of the sampled holds; worker pools are
+ * listed by the request queue of their dispatch class.
+ */
+void rpc_stats_print(FILE* out)
+{
+	os_queue_stats_t st[RPC_STATS_MAX_QUEUES];
+	os_mutex_stats_t ms[RPC_STATS_MAX_MUTEXES];
+
+	if (!out) return;
+
+	size_t n = os_queue_list_stats(st, RPC_STATS_MAX_QUEUES);
+	if (n > RPC_STATS_MAX_QUEUES) n = RPC_STATS_MAX_QUEUES;
+
+	fprintf(out, "%-14s %5s %5s %5s %10s %10s %8s %10s %7s %7s %9s %7s %7s\n",
+	        "queue", "cap", "depth", "hwm", "sent", "received", "blocked", "blk_us",
+	        "snd_to", "rcv_to", "res_mean", "res_p50", "res_p99");
+
+	for (size_t i = 0; i < n; i++) {
+		const os_queue_stats_t* s = &st[i];
+		double mean = s->residence_samples
+				? (double)s->residence_us / (double)s->residence_samples : 0.0;
+
+		fprintf(out, "%-14s %5zu %5zu %5zu %10llu %10llu %8llu %10llu %7llu %7llu %9.1f %7llu %7llu\n",
+		        s->name ? s->name : "?", s->capacity, s->depth, s->high_water,
+		        (unsigned long long)s->sent, (unsigned long long)s->received,
+		        (unsigned long long)s->blocked_sends, (unsigned long long)s->blocked_send_us,
+		        (unsigned long long)s->send_timeouts, (unsigned long long)s->recv_timeouts,
+		        mean,
+		        (unsigned long long)hist_quantile_us(s, 0.50),
+		        (unsigned long long)hist_quantile_us(s, 0.99));
+	}
+
+	n = os_mutex_list_stats(ms, RPC_STATS_MAX_MUTEXES);
+	if (n > RPC_STATS_MAX_MUTEXES) n = RPC_STATS_MAX_MUTEXES;
+
+	fprintf(out, "\n%-14s %10s %10s %8s %10s %10s %10s %10s\n",
+	        "lock", "acquired", "contended", "cont_%", "wait_us", "wait_max", "hold_mean", "hold_max");
+
+	for (size_t i = 0; i < n; i++) {
+		const os_mutex_stats_t* m = &ms[i];
+		double pct = m->acquisitions
+				? 100.0 * (double)m->contended / (double)m->acquisitions : 0.0;
+		double hold = m->hold_samples
+				? (double)m->hold_ns / (double)m->hold_samples / 1e3 : 0.0;
+
+		fprintf(out, "%-14s %10llu %10llu %8.2f %10.1f %10.1f %10.2f %10.1f\n",
+		        m->name ? m->name : "?",
+		        (unsigned long long)m->acquisitions, (unsigned long long)m->contended, pct,
+		        (double)m->wait_ns / 1e3, (double)m->max_wait_ns / 1e3,
+		        hold, (double)m->max_hold_ns / 1e3);
+	}
+
+	fprintf(out, "\n%-20s %7s %7s %7s %7s %10s %10s %10s\n",
+	        "pool", "workers", "min", "max", "hwm", "spawned", "retired", "expired");
+
+	rpc_pool_stats_t ps;
+	for (uint8_t c = 0; rpc_trans_pool_stats(c, &ps) == RPC_SUCCESS; c++) {
+		fprintf(out, "%-20s %7u %7u %7u %7u %10llu %10llu %10llu\n",
+		        rpc_trans_class_queue(c), ps.workers, ps.min_workers, ps.max_workers,
+		        ps.high_water, (unsigned long long)ps.spawned, (unsigned long long)ps.retired,
+		        (unsigned long long)ps.expired);
+	}
+}
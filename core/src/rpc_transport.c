@@ -8,62 +8,245 @@
  * - Request/response synchronization
  * - Worker thread management
  * - Stream message handling
+ * - Completion delivery to an application event loop (rpc_poll)
  */
 
 
+#include <stdatomic.h>
 #include "rpc_transport.h"
 
 
 // === Worker Structure ===
 
 /**
- * @brief RPC request structure used by worker threads.
+ * @brief RPC request descriptor used by worker threads.
+ *
+ * Name and arguments point into the RX buffer the request arrived in
+ * (the name of a request sent by method ID is the shared table's); the
+ * worker owns that buffer and releases it when done.
  */
 typedef struct {
-    uint8_t type;                            /**< Message type: REQ, RESP, ERR, STREAM */
-    uint8_t seq;                             /**< Sequence number of the request */
-    char name[MAX_FUNC_NAME_LEN + 1];        /**< Function name */
-    uint8_t args[MAX_FUNC_ARGS_RESP_SIZE];   /**< Function arguments */
+    rpc_buf_t* buf;                          /**< RX buffer holding the message */
+    const char* name;                        /**< Function name (inside @c buf), "?" for an unknown ID */
+    const uint8_t* args;                     /**< Function arguments (inside @c buf) */
     uint16_t alen;                           /**< Length of arguments */
+    rpc_fn_t fn;                             /**< Registered handler, NULL if none */
+    uint64_t queued_ns;                      /**< os_time_ns() when queued (elastic classes only) */
+    uint64_t deadline_ms;                    /**< Caller's deadline on os_time_ms(), 0 if none was sent */
+    uint8_t cls;                             /**< Dispatch class */
+    uint16_t id;                             /**< Method ID the request was sent by, 0 if sent by name */
+    uint32_t seq;                            /**< Sequence number of the request */
+    uint8_t type;                            /**< Message type: REQ, RESP, ERR, STREAM */
 } rpc_request_t;
 
-static os_queue_t qRpcRequests;   /**< Shared queue for all RPC workers */
-static uint8_t worker_count = 0;  /**< Worker counter (for numbering threads) */
+typedef struct dclass dclass_t;
+
+/**
+ * @brief Worker thread of a dispatch class.
+ */
+typedef struct {
+	dclass_t* k;               /**< Class served */
+	os_queue_t q;              /**< Own deque (work stealing), otherwise the class queue */
+	_Atomic bool idle;         /**< Found no work anywhere and sleeps on @c q */
+	_Atomic bool used;         /**< A thread runs in this slot */
+	uint8_t index;             /**< Index within the class */
+	char qname[40];            /**< Name of the own deque in the statistics */
+} worker_t;
+
+/**
+ * @brief Dispatch class: a request queue and the workers serving it.
+ *
+ * With work stealing every worker has a deque of its own instead and @c q
+ * is NULL. An elastic class (cfg.max_workers above cfg.workers) always
+ * shares @c q and runs between cfg.workers and cfg.max_workers threads.
+ */
+struct dclass {
+	os_queue_t q;              /**< Requests for the class's methods */
+	rpc_class_cfg_t cfg;       /**< Workers, queue depth and scheduling (defaults applied) */
+	worker_t* w;               /**< Worker slots, cfg.max_workers entries */
+	bool steal;                /**< Per-worker deques with work stealing */
+	bool elastic;              /**< Workers are started and retired with the load */
+	size_t next;               /**< Round-robin position of the transport thread */
+	_Atomic uint8_t live;      /**< Worker threads running */
+	_Atomic uint8_t idle;      /**< Workers waiting for a request (elastic only) */
+	_Atomic bool growing;      /**< A started worker has not run yet */
+	_Atomic size_t queued;     /**< Requests in @c q (elastic only) */
+	_Atomic uint8_t high_water;   /**< Most workers running at once */
+	_Atomic uint64_t spawned;     /**< Workers started beyond the minimum */
+	_Atomic uint64_t retired;     /**< Workers that exited after lingering idle */
+	_Atomic uint64_t expired;     /**< Requests shed: their caller's deadline had passed */
+	_Atomic uint32_t started;     /**< Threads started so far (numbers their names) */
+	char qname[32];            /**< Name of @c q in the statistics */
+};
+
+static dclass_t s_class[RPC_CLASS_MAX]; /**< Dispatch classes; 0 is the default class */
+static size_t s_class_count;      /**< Classes created */
+static rpc_sched_t s_sched;       /**< How workers share the requests of a class */
+static uint32_t worker_count = 0; /**< Worker counter (for numbering threads) */
 static os_mutex_t s_worker_count; /**< Mutex to protect worker_count */
 
+static void rpc_worker_handle(uint32_t worker_num, const rpc_request_t* req);
+static void rpc_worker_grow(dclass_t* k);
+static void rpc_trans_on_timeout(void* arg);
+
 
 // === Function Registry ===
 
 /**
  * @brief Registered function entry.
+ *
+ * @c name is written last, with release order: a reader that sees it also
+ * sees @c fn and @c hash.
  */
 typedef struct {
-	const char* name;    /**< Function name (static string) */
-	rpc_fn_t fn;         /**< Function pointer */
+	_Atomic(const char*) name; /**< Function name (static string), NULL = free slot */
+	_Atomic(rpc_fn_t) fn;      /**< Function pointer, NULL if the name only has a method ID */
+	_Atomic uint16_t id;       /**< Shared method ID, 0 if none */
+	_Atomic uint8_t cls;       /**< Dispatch class, published with @c fn */
+	uint32_t hash;             /**< rpc_trans_name_hash() of the name */
 } reg_entry_t;
 
-static reg_entry_t s_reg[NUM_REG_FUNC]; /**< Registry of functions */
-static size_t s_reg_count = 0;          /**< Number of registered functions */
-static os_mutex_t s_reg_mtx;            /**< Mutex for registry access */
+/**
+ * @brief Open-addressing (linear probing) table of registered functions.
+ *
+ * Slots are only ever filled, never emptied or moved, so lookups need no
+ * lock while a registration adds an entry. A table that would become more
+ * than three quarters full is replaced by a copy of twice the size;
+ * superseded tables stay allocated, since a lookup may still probe them.
+ */
+typedef struct reg_table {
+	size_t mask;               /**< Number of slots - 1 (power of two) */
+	size_t count;              /**< Occupied slots */
+	struct reg_table* prev;    /**< Superseded table */
+	reg_entry_t slot[];        /**< Entries */
+} reg_table_t;
+
+static _Atomic(reg_table_t*) s_reg;     /**< Current registry table, NULL until the first registration */
+static os_mutex_t s_reg_mtx;            /**< Serializes registrations */
+
+/**
+ * @brief Method reachable by its shared ID.
+ */
+typedef struct {
+	const char* name;          /**< Function name, NULL if the ID is not in the method table */
+	_Atomic(rpc_fn_t) fn;      /**< Registered handler, NULL until registered */
+	_Atomic uint8_t cls;       /**< Dispatch class, published with @c fn */
+} method_slot_t;
+
+static method_slot_t s_method[RPC_METHOD_ID_MAX]; /**< Methods indexed by shared ID */
 
 
 // === Response Waiters ===
 
+/**
+ * @brief Requests of one rpc_trans_request_batch() call, on the caller's stack.
+ */
+typedef struct {
+	_Atomic size_t left;      /**< Requests not yet resolved */
+	os_sem_t done;            /**< Given when the last one resolves */
+} batch_t;
+
 /**
  * @brief Waiter structure for pending RPC requests.
+ *
+ * The sequence number of a request is its waiter's index in the table plus
+ * RPC_WAITER_MAX times the waiter's generation, which grows with every
+ * reuse: a response is routed by indexing the table with seq & mask, and
+ * a stale one (for an earlier generation) no longer matches.
  */
 typedef struct {
-	uint8_t seq;              /**< Sequence number */
+	_Atomic uint32_t pending; /**< Sequence number while not yet resolved, 0 otherwise */
+	_Atomic uint32_t timed_out; /**< Sequence number of the last request that timed out here */
+	uint32_t seq;             /**< Sequence number of the current request */
+	uint32_t index;           /**< Position in the waiter table */
+	uint32_t gen;             /**< Generation: requests issued through this waiter */
 	os_sem_t done;            /**< Semaphore signaled when response is ready */
 	int result_code;          /**< Result code (0 = OK, <0 = error) */
 	uint8_t* resp_buf;        /**< Response buffer pointer */
 	uint16_t* resp_len;       /**< Pointer to actual response length */
 	uint16_t resp_buf_cap;    /**< Capacity of the response buffer */
-	bool in_use;              /**< Marks if this waiter is active */
+	os_wtimer_t timer;        /**< Request deadline */
+	uint32_t rtt_tag;         /**< Round-trip estimate key of the called method */
+	uint64_t sent_ns;         /**< Time the request was sent (os_time_ns()) */
+	uint8_t kind;             /**< Who takes the outcome (wait_kind_t) */
+	rpc_done_fn done_fn;      /**< Completion callback (WAIT_CALLBACK) */
+	void* user;               /**< Argument of @c done_fn */
+	_Atomic uint32_t fstate;  /**< Future state, FUT_* bits (WAIT_FUTURE) */
+	_Atomic(os_sem_t) wake;   /**< Given when a future resolves: @c done, or that of a wait-any group */
+	batch_t* batch;           /**< Batch the request belongs to (WAIT_BATCH) */
+	uint16_t async_len;       /**< Response length (asynchronous request) */
+	uint8_t async_resp[MAX_FUNC_ARGS_RESP_SIZE]; /**< Response storage (asynchronous request) */
 } waiter_t;
 
-static waiter_t s_wait[REQ_TABLE_SIZE]; /**< Array of waiters */
-static os_mutex_t s_wait_mtx;           /**< Mutex for waiter access */
+/**
+ * @brief Who takes the outcome of a request.
+ */
+typedef enum {
+	WAIT_SYNC,     /**< Caller blocked in rpc_trans_request() */
+	WAIT_CALLBACK, /**< Completion callback, run by the executor or rpc_trans_poll() */
+	WAIT_FUTURE,   /**< Future, waited for and released by the caller */
+	WAIT_BATCH     /**< Caller blocked in rpc_trans_request_batch() until the whole batch resolves */
+} wait_kind_t;
+
+#define FUT_RESOLVED   1u /**< Outcome stored */
+#define FUT_SIGNALLED  2u /**< Wakeup given; the resolving thread is done with the waiter */
+#define FUT_RELEASED   4u /**< Handle given up by the caller */
+
+/** Waiter table chunks (REQ_TABLE_SIZE waiters each), allocated as the table grows */
+static waiter_t* _Atomic s_wait[RPC_WAITER_MAX / REQ_TABLE_SIZE];
+static size_t s_wait_chunks;            /**< Allocated chunks */
+static size_t s_wait_chunks_max;        /**< Chunk limit (all created at init in arena mode) */
+static os_mutex_t s_wait_mtx;           /**< Serializes waiter table growth */
+static os_queue_t qFreeWaiters;         /**< Indices of free waiters */
+/**
+ * @brief Caller queued for a free waiter while the table is at its size limit.
+ */
+typedef struct park {
+	struct park* next;        /**< Next caller in arrival order */
+	os_sem_t sem;             /**< Given when a waiter is handed over */
+	uint32_t index;           /**< Waiter handed over, PARK_NONE until then */
+} park_t;
+
+#define PARK_NONE  UINT32_MAX /**< No waiter handed over yet */
+
+static park_t* s_park_head;             /**< Oldest queued caller (under s_wait_mtx) */
+static park_t** s_park_tail = &s_park_head; /**< Link to append the next one at */
+static os_sem_t s_park_sem[RPC_WAITER_PARK_MAX]; /**< Unused parking semaphores (under s_wait_mtx) */
+static size_t s_park_sem_n;             /**< Number of them */
+static _Atomic uint32_t s_parked;       /**< Callers queued (read without the lock) */
+static rpc_executor_t s_exec;           /**< Runs completion callbacks, NULL submit: rpc_trans_poll() */
+
+
+// === Round-Trip Estimates ===
+
+/**
+ * @brief Smoothed round trip of a remote method, steering adaptive waits.
+ *
+ * Direct-mapped by name hash; updates race benignly since it is only an
+ * estimate, and a method whose hash takes over a slot starts afresh.
+ */
+typedef struct {
+	_Atomic uint32_t tag;     /**< Name hash of the method (0 = unused) */
+	_Atomic uint32_t rtt_ns;  /**< Smoothed round trip in nanoseconds */
+} rtt_entry_t;
+
+static rtt_entry_t s_rtt[RPC_RTT_TABLE_SIZE]; /**< Round-trip estimates */
+static rpc_wait_t s_wait_mode = RPC_WAIT_MODE_DEFAULT;     /**< Default wait strategy */
+static uint32_t s_spin_max_ns = RPC_WAIT_SPIN_MAX_US * 1000u; /**< Default spin limit */
+
+
+// === Timers ===
+
+static os_twheel_t s_timers;            /**< Request and handler deadlines */
+
+
+// === Poll Integration ===
+
+static os_event_t s_poll_ev;            /**< Readable while completions or streams await rpc_poll() */
+static atomic_bool s_poll_signalled;    /**< s_poll_ev signalled since the last rpc_poll() */
+static os_queue_t qPollDone;            /**< Resolved asynchronous waiters */
+static os_queue_t qPollStreams;         /**< Incoming streams handed to rpc_poll() */
+static bool s_poll_streams;             /**< Streams go to qPollStreams instead of the workers */
 
 
 // === Inter-layer queues ===
@@ -72,40 +255,369 @@ os_queue_t qLinkToTrans; /**< Queue from link layer to transport */
 os_queue_t qTransToLink; /**< Queue from transport to link layer */
 
 
+// === Runtime ===
+
+static rpc_runtime_t s_runtime;  /**< Runtime selected at init */
+static os_mutex_t s_tx_mtx;      /**< Serializes direct PHY writes (reactor runtime) */
+
+
 // === Helper Functions ===
 
 /**
- * @brief Find a registered function by name.
+ * @brief Create a mutex shared between thread roles.
+ *
+ * Uses priority inheritance when RPC_MUTEX_PRIO_INHERIT is enabled, so a
+ * real-time thread never waits on a preempted lower-priority holder.
+ *
+ * @return Mutex handle, NULL on failure.
+ */
+static os_mutex_t rpc_trans_mutex_create(void)
+{
+	return RPC_MUTEX_PRIO_INHERIT ? os_mutex_create_pi() : os_mutex_create();
+}
+
+
+/**
+ * @brief Hash of a method name (FNV-1a over at most MAX_FUNC_NAME_LEN bytes).
+ *
+ * @param name Function name.
+ * @return Hash.
+ */
+static uint32_t rpc_trans_name_hash(const char* name)
+{
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < MAX_FUNC_NAME_LEN && name[i]; i++)
+		h = (h ^ (uint8_t)name[i]) * 16777619u;
+	return h;
+}
+
+
+/**
+ * @brief Round-trip estimate key of a method name (never 0).
+ *
+ * @param name Function name.
+ * @return Key for rpc_trans_rtt_get() / rpc_trans_rtt_add().
+ */
+static uint32_t rpc_trans_rtt_tag(const char* name)
+{
+	return rpc_trans_name_hash(name) | 1u;
+}
+
+
+/**
+ * @brief Smoothed round trip of a method.
+ *
+ * @param tag Method key.
+ * @return Estimate in nanoseconds, 0 if none yet.
+ */
+static uint32_t rpc_trans_rtt_get(uint32_t tag)
+{
+	rtt_entry_t* e = &s_rtt[tag & (RPC_RTT_TABLE_SIZE - 1)];
+	if (atomic_load_explicit(&e->tag, memory_order_relaxed) != tag) return 0;
+	return atomic_load_explicit(&e->rtt_ns, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Fold a measured round trip into the method's estimate (EWMA, 1/8 weight).
+ *
+ * @param tag Method key.
+ * @param ns Measured round trip in nanoseconds.
+ */
+static void rpc_trans_rtt_add(uint32_t tag, uint64_t ns)
+{
+	rtt_entry_t* e = &s_rtt[tag & (RPC_RTT_TABLE_SIZE - 1)];
+	uint32_t sample = (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+
+	if (atomic_load_explicit(&e->tag, memory_order_relaxed) != tag) {
+		atomic_store_explicit(&e->rtt_ns, sample, memory_order_relaxed);
+		atomic_store_explicit(&e->tag, tag, memory_order_relaxed);
+		return;
+	}
+	uint32_t old = atomic_load_explicit(&e->rtt_ns, memory_order_relaxed);
+	int64_t next = (int64_t)old + ((int64_t)sample - (int64_t)old) / 8;
+	atomic_store_explicit(&e->rtt_ns, (uint32_t)next, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Spin budget of a synchronous wait for a response.
+ *
+ * An adaptive wait spins for the method's estimate plus half of it, so
+ * the response usually lands within the spin; methods with no estimate yet
+ * spin up to the limit, methods slower than the limit do not spin at all.
+ *
+ * @param tag Method key.
+ * @param opts Call options, NULL for the defaults.
+ * @return Spin time in nanoseconds, 0 to sleep at once.
+ */
+static uint32_t rpc_trans_spin_budget(uint32_t tag, const rpc_call_opts_t* opts)
+{
+	rpc_wait_t mode = (opts && opts->wait != RPC_WAIT_DEFAULT) ? opts->wait : s_wait_mode;
+	uint32_t max_ns = (opts && opts->spin_max_us) ? opts->spin_max_us * 1000u : s_spin_max_ns;
+
+	if (mode != RPC_WAIT_ADAPTIVE) return 0;
+
+	uint32_t rtt = rpc_trans_rtt_get(tag);
+	if (rtt == 0) return max_ns;
+	if (rtt > max_ns) return 0;
+
+	uint64_t spin = (uint64_t)rtt + rtt / 2;
+	return (spin > max_ns) ? max_ns : (uint32_t)spin;
+}
+
+
+/**
+ * @brief Look a name up in a registry table.
+ *
+ * @param t Table, may be NULL.
+ * @param name Function name.
+ * @param hash rpc_trans_name_hash() of @p name.
+ * @return Entry, NULL if the name is not in the table.
+ */
+static reg_entry_t* reg_table_find(reg_table_t* t, const char* name, uint32_t hash)
+{
+	if (!t) return NULL;
+
+	// The load factor stays below 1, so a free slot ends every probe
+	for (size_t i = hash & t->mask;; i = (i + 1) & t->mask) {
+		reg_entry_t* e = &t->slot[i];
+		const char* n = atomic_load_explicit(&e->name, memory_order_acquire);
+		if (!n) return NULL;
+		if (e->hash == hash && strncmp(n, name, MAX_FUNC_NAME_LEN) == 0) return e;
+	}
+}
+
+
+/**
+ * @brief Add an entry to a registry table (under s_reg_mtx, table not full).
+ */
+static void reg_table_put(reg_table_t* t, const char* name, uint32_t hash,
+                          rpc_fn_t fn, uint16_t id, uint8_t cls)
+{
+	size_t i = hash & t->mask;
+	while (atomic_load_explicit(&t->slot[i].name, memory_order_relaxed))
+		i = (i + 1) & t->mask;
+
+	atomic_store_explicit(&t->slot[i].fn, fn, memory_order_relaxed);
+	atomic_store_explicit(&t->slot[i].id, id, memory_order_relaxed);
+	atomic_store_explicit(&t->slot[i].cls, cls, memory_order_relaxed);
+	t->slot[i].hash = hash;
+	atomic_store_explicit(&t->slot[i].name, name, memory_order_release); // Publish
+	t->count++;
+}
+
+
+/**
+ * @brief Create a registry table holding the entries of @p old.
+ *
+ * @param old Table to copy, may be NULL.
+ * @param slots Number of slots (power of two, more than the entries of @p old).
+ * @return New table, NULL if out of memory.
+ */
+static reg_table_t* reg_table_create(reg_table_t* old, size_t slots)
+{
+	reg_table_t* t = os_mem_alloc(sizeof(*t) + slots * sizeof(t->slot[0]));
+	if (!t) return NULL;
+
+	t->mask = slots - 1;
+	t->prev = old;
+	for (size_t i = 0; old && i <= old->mask; i++) {
+		const char* n = atomic_load_explicit(&old->slot[i].name, memory_order_relaxed);
+		if (n) reg_table_put(t, n, old->slot[i].hash,
+		                     atomic_load_explicit(&old->slot[i].fn, memory_order_relaxed),
+		                     atomic_load_explicit(&old->slot[i].id, memory_order_relaxed),
+		                     atomic_load_explicit(&old->slot[i].cls, memory_order_relaxed));
+	}
+	return t;
+}
+
+
+/**
+ * @brief Slots of the table that replaces @p t (the first one if NULL).
+ *
+ * Keeps at most three quarters of the slots occupied, so probes stay
+ * short, and starts large enough for NUM_REG_FUNC functions.
+ */
+static size_t reg_table_slots(const reg_table_t* t)
+{
+	size_t slots = t ? 2 * (t->mask + 1) : 4;
+	while (4 * NUM_REG_FUNC > 3 * slots) slots *= 2;
+	return slots;
+}
+
+
+/**
+ * @brief Find the registry entry of a name, adding it if missing (under s_reg_mtx).
+ *
+ * @param name Function name.
+ * @param hash rpc_trans_name_hash() of @p name.
+ * @param fn Function pointer of a new entry.
+ * @param id Method ID of a new entry.
+ * @param cls Dispatch class of a new entry.
+ * @param added Output: whether a new entry was added.
+ * @return Entry, NULL if out of memory.
+ */
+static reg_entry_t* reg_get(const char* name, uint32_t hash, rpc_fn_t fn, uint16_t id,
+                            uint8_t cls, bool* added)
+{
+	reg_table_t* t = atomic_load_explicit(&s_reg, memory_order_relaxed);
+	reg_entry_t* e = reg_table_find(t, name, hash);
+
+	*added = !e;
+	if (e) return e;
+
+	if (!t || 4 * (t->count + 1) > 3 * (t->mask + 1)) {
+		reg_table_t* grown = reg_table_create(t, reg_table_slots(t));
+		if (!grown) return NULL;
+		atomic_store_explicit(&s_reg, grown, memory_order_release);
+		t = grown;
+	}
+
+	reg_table_put(t, name, hash, fn, id, cls);
+	return reg_table_find(t, name, hash);
+}
+
+
+/**
+ * @brief Find a registered function by name, without locking.
+ */
+rpc_fn_t rpc_trans_find_fn(const char* name)
+{
+	if (!name) return NULL;
+
+	reg_entry_t* e = reg_table_find(atomic_load_explicit(&s_reg, memory_order_acquire),
+	                                name, rpc_trans_name_hash(name));
+	return e ? atomic_load_explicit(&e->fn, memory_order_acquire) : NULL;
+}
+
+
+/**
+ * @brief Find the handler of an incoming request and its dispatch class.
+ *
+ * By method ID an array index, by name a registry lookup; lock-free.
+ *
+ * @param name Function name.
+ * @param id Method ID the request was sent by, 0 if sent by name.
+ * @param cls Output: dispatch class (0 if there is no handler).
+ * @return Function pointer, NULL if no function is registered.
+ */
+static rpc_fn_t rpc_trans_lookup(const char* name, uint16_t id, uint8_t* cls)
+{
+	_Atomic(rpc_fn_t)* fn;
+	_Atomic uint8_t* c;
+
+	*cls = 0;
+	if (id) {
+		if (id >= RPC_METHOD_ID_MAX) return NULL;
+		fn = &s_method[id].fn;
+		c = &s_method[id].cls;
+	} else {
+		reg_entry_t* e = reg_table_find(atomic_load_explicit(&s_reg, memory_order_acquire),
+		                                name, rpc_trans_name_hash(name));
+		if (!e) return NULL;
+		fn = &e->fn;
+		c = &e->cls;
+	}
+
+	rpc_fn_t f = atomic_load_explicit(fn, memory_order_acquire);
+	if (f) *cls = atomic_load_explicit(c, memory_order_relaxed);
+	return f;
+}
+
+
+/**
+ * @brief Method ID a name is sent by.
  *
  * @param name Function name.
- * @return Index of function or RPC_ERROR if not found.
+ * @return ID from the shared method table, 0 to send the name.
  */
-static int find_reg(const char* name)
+static uint16_t rpc_trans_method_id(const char* name)
+{
+	reg_entry_t* e = reg_table_find(atomic_load_explicit(&s_reg, memory_order_acquire),
+	                                name, rpc_trans_name_hash(name));
+	return e ? atomic_load_explicit(&e->id, memory_order_relaxed) : 0;
+}
+
+
+int register_fn(const char* name, rpc_fn_t fn)
+{
+	return register_fn_ex(name, fn, 0);
+}
+
+
+int register_fn_ex(const char* name, rpc_fn_t fn, uint8_t cls)
 {
-	int idx = RPC_ERROR;
+	if (!name || !fn) return RPC_ERROR_INVALID_ARGS;
+	if (cls >= s_class_count) {
+		RPC_LOG_ERROR("No dispatch class %u for %s", cls, name);
+		return RPC_ERROR_INVALID_ARGS;
+	}
+
+	uint32_t hash = rpc_trans_name_hash(name);
+	int rc = RPC_SUCCESS;
+	bool added;
 
 	os_mutex_lock(s_reg_mtx);
-	for (size_t i = 0; i < s_reg_count; i++) {
-		if (strncmp(s_reg[i].name, name, MAX_FUNC_NAME_LEN) == 0) {
-			idx = (int)i;
-			break;
+	reg_entry_t* e = reg_get(name, hash, fn, 0, cls, &added);
+	if (!e) {
+		rc = RPC_ERROR;
+	} else if (!added && !atomic_load_explicit(&e->fn, memory_order_relaxed)) {
+		// A method table name: now reachable by its ID as well
+		atomic_store_explicit(&e->cls, cls, memory_order_relaxed);
+		atomic_store_explicit(&e->fn, fn, memory_order_release);
+		uint16_t id = atomic_load_explicit(&e->id, memory_order_relaxed);
+		if (id) {
+			atomic_store_explicit(&s_method[id].cls, cls, memory_order_relaxed);
+			atomic_store_explicit(&s_method[id].fn, fn, memory_order_release);
 		}
-	}
+	} // Otherwise the first registration of a name stays in effect
 	os_mutex_unlock(s_reg_mtx);
 
-	return idx;
+	return rc;
 }
 
-int register_fn(const char* name, rpc_fn_t fn)
+
+/**
+ * @brief Install the method table shared with the peer.
+ */
+int rpc_trans_set_methods(const rpc_method_t* methods, size_t count)
 {
-	int rc = RPC_ERROR;
+	if (count && !methods) return RPC_ERROR_INVALID_ARGS;
+
+	// Validate first, so a bad table changes nothing
+	for (size_t i = 0; i < count; i++) {
+		const rpc_method_t* m = &methods[i];
+		size_t nlen = m->name ? strlen(m->name) : 0;
+		if (nlen < MIN_FUNC_NAME_LEN || nlen > MAX_FUNC_NAME_LEN ||
+		    m->id == 0 || m->id >= RPC_METHOD_ID_MAX) {
+			RPC_LOG_ERROR("Invalid method table entry %zu: %s = %u",
+			              i, m->name ? m->name : "NULL", m->id);
+			return RPC_ERROR_INVALID_ARGS;
+		}
+		for (size_t j = 0; j < i; j++) {
+			if (methods[j].id == m->id || strcmp(methods[j].name, m->name) == 0) {
+				RPC_LOG_ERROR("Duplicate method table entry: %s = %u", m->name, m->id);
+				return RPC_ERROR_INVALID_ARGS;
+			}
+		}
+	}
 
+	int rc = RPC_SUCCESS;
 	os_mutex_lock(s_reg_mtx);
-	if (s_reg_count < (sizeof(s_reg)/sizeof(s_reg[0]))) {
-		s_reg[s_reg_count].name = name;
-		s_reg[s_reg_count].fn = fn;
-		s_reg_count++;
-		rc = RPC_SUCCESS;
+	for (size_t i = 0; i < count && rc == RPC_SUCCESS; i++) {
+		const rpc_method_t* m = &methods[i];
+		bool added;
+		reg_entry_t* e = reg_get(m->name, rpc_trans_name_hash(m->name), NULL, m->id, 0, &added);
+		if (!e) { rc = RPC_ERROR; break; }
+
+		// Functions registered before the table keep their handler
+		atomic_store_explicit(&e->id, m->id, memory_order_relaxed);
+		s_method[m->id].name = m->name;
+		atomic_store_explicit(&s_method[m->id].cls, atomic_load_explicit(&e->cls, memory_order_relaxed),
+		                      memory_order_relaxed);
+		atomic_store_explicit(&s_method[m->id].fn, atomic_load_explicit(&e->fn, memory_order_relaxed),
+		                      memory_order_release);
 	}
 	os_mutex_unlock(s_reg_mtx);
 
@@ -114,57 +626,123 @@ int register_fn(const char* name, rpc_fn_t fn)
 
 
 /**
- * @brief Build a transport message.
+ * @brief Store a sequence number (SEQ_MSG_SIZE bytes, little-endian).
+ */
+static inline void rpc_trans_put_seq(uint8_t* out, uint32_t seq)
+{
+	for (size_t i = 0; i < SEQ_MSG_SIZE; i++) out[i] = (uint8_t)(seq >> (8 * i));
+}
+
+
+/**
+ * @brief Load a sequence number (SEQ_MSG_SIZE bytes, little-endian).
+ */
+static inline uint32_t rpc_trans_get_seq(const uint8_t* in)
+{
+	uint32_t seq = 0;
+	for (size_t i = 0; i < SEQ_MSG_SIZE; i++) seq |= (uint32_t)in[i] << (8 * i);
+	return seq;
+}
+
+
+/**
+ * @brief Build a transport message header (everything before the arguments).
+ *
+ * A message with a method ID carries the ID (16 bits, little-endian) in
+ * place of the null-terminated name, and MSG_ID_FLAG in its type. A
+ * request with a deadline budget carries it (milliseconds, 16 bits,
+ * little-endian) right after the sequence number, and MSG_BUDGET_FLAG in
+ * its type.
  *
  * @param type Message type (MSG_REQ, MSG_RESP, MSG_ERR, MSG_STREAM).
  * @param seq Sequence number.
  * @param name Function name.
- * @param args Pointer to arguments buffer.
- * @param alen Length of arguments.
+ * @param id Method ID, 0 to send the name.
+ * @param budget Caller's remaining time in milliseconds, 0 to send none.
  * @param out Output buffer.
  * @param olen Output buffer capacity.
- * @return Size of the serialized payload, 0 on error.
+ * @return Size of the serialized header, 0 on error.
  */
-static size_t rpc_trans_build_msg(uint8_t type, uint8_t seq, const char* name,
-                                  const uint8_t* args, uint16_t alen,
-                                  uint8_t* out, size_t olen)
+static size_t rpc_trans_build_hdr(uint8_t type, uint32_t seq, const char* name, uint16_t id,
+                                  uint16_t budget, uint8_t* out, size_t olen)
 {
 	// Check input arguments
-    if (!out || !name) return 0;
+    if (!out || (!name && !id)) return 0;
 
     // Check message type
     if (type != MSG_REQ && type != MSG_RESP && type != MSG_ERR && type != MSG_STREAM) {
         return 0;
     }
 
-    // Check name
-    size_t nlen = strlen(name);
-    if (nlen < MIN_FUNC_NAME_LEN || nlen > MAX_FUNC_NAME_LEN)
+    size_t pos = TYPE_MSG_SIZE + SEQ_MSG_SIZE + (budget ? BUDGET_MSG_SIZE : 0);
+    if (pos > olen)
         return 0;
 
-    // Checking arguments
-    if (alen > MAX_FUNC_ARGS_RESP_SIZE)
-        return 0;
+    out[0] = type | (id ? MSG_ID_FLAG : 0) | (budget ? MSG_BUDGET_FLAG : 0);
+    rpc_trans_put_seq(&out[TYPE_MSG_SIZE], seq);
+    if (budget) {
+        out[TYPE_MSG_SIZE + SEQ_MSG_SIZE] = (uint8_t)budget;
+        out[TYPE_MSG_SIZE + SEQ_MSG_SIZE + 1] = (uint8_t)(budget >> 8);
+    }
 
-    // Checking arguments
-    size_t need = TYPE_MSG_SIZE + SEQ_MSG_SIZE + nlen + TERM_SIZE + alen;
+    if (id) {
+        if (pos + METHOD_ID_SIZE > olen)
+            return 0;
+
+        out[pos] = (uint8_t)id;
+        out[pos + 1] = (uint8_t)(id >> 8);
+        return pos + METHOD_ID_SIZE;
+    }
 
-    if (need < MIN_PAYLOAD_SIZE || need > MAX_PAYLOAD_SIZE)
+    // Check name
+    size_t nlen = strlen(name);
+    if (nlen < MIN_FUNC_NAME_LEN || nlen > MAX_FUNC_NAME_LEN)
         return 0;
 
+    size_t need = pos + nlen + TERM_SIZE;
     if (need > olen)
         return 0;
 
     // Serialization
-    size_t pos = 0;
-    out[pos++] = type;
-    out[pos++] = seq;
-
     memcpy(&out[pos], name, nlen);
     pos += nlen;
 
     out[pos++] = '\0'; // terminating null of name
 
+    return pos; // header size
+}
+
+
+/**
+ * @brief Build a transport message.
+ *
+ * @param type Message type (MSG_REQ, MSG_RESP, MSG_ERR, MSG_STREAM).
+ * @param seq Sequence number.
+ * @param name Function name.
+ * @param id Method ID, 0 to send the name.
+ * @param budget Caller's remaining time in milliseconds, 0 to send none.
+ * @param args Pointer to arguments buffer.
+ * @param alen Length of arguments.
+ * @param out Output buffer.
+ * @param olen Output buffer capacity.
+ * @return Size of the serialized payload, 0 on error.
+ */
+static size_t rpc_trans_build_msg(uint8_t type, uint32_t seq, const char* name, uint16_t id,
+                                  uint16_t budget, const uint8_t* args, uint16_t alen,
+                                  uint8_t* out, size_t olen)
+{
+    // Checking arguments
+    if (alen > MAX_FUNC_ARGS_RESP_SIZE)
+        return 0;
+
+    size_t pos = rpc_trans_build_hdr(type, seq, name, id, budget, out, olen);
+    if (!pos)
+        return 0;
+
+    size_t need = pos + alen;
+    if (need < MIN_PAYLOAD_SIZE || need > MAX_PAYLOAD_SIZE || need > olen)
+        return 0;
+
     if (alen && args) {
         memcpy(&out[pos], args, alen);
         pos += alen;
@@ -175,41 +753,164 @@ static size_t rpc_trans_build_msg(uint8_t type, uint8_t seq, const char* name,
 
 
 /**
- * @brief Parse a transport message.
+ * @brief Frame a message on the stack and write it to the PHY (reactor
+ *        runtime, under s_tx_mtx).
  *
- * @param in Input buffer.
- * @param ilen Input length.
- * @param type Output: message type.
- * @param seq Output: sequence number.
- * @param name Output: pointer to function name.
- * @param args Output: pointer to arguments.
- * @param alen Output: arguments length.
  * @return RPC_SUCCESS on success, RPC_ERROR otherwise.
  */
-static int rpc_trans_parse_msg(const uint8_t* in, size_t ilen,
-					           uint8_t* type, uint8_t* seq,
-					           const char** name, const uint8_t** args, uint16_t* alen)
+static int rpc_trans_write_msg(uint8_t type, uint32_t seq, const char* name, uint16_t id,
+                               uint16_t budget, const uint8_t* args, uint16_t alen)
 {
-	// Checking pointers
-	if (!in || !type || !seq || !name || !args || !alen)
-		return RPC_ERROR;
+	uint8_t frame[LINK_HEADROOM + MAX_PAYLOAD_SIZE + LINK_TAILROOM];
+	size_t len = rpc_trans_build_msg(type, seq, name, id, budget, args, alen,
+	                                 frame + LINK_HEADROOM, MAX_PAYLOAD_SIZE);
+	if (!len) return RPC_ERROR;
 
-	// Payload Boundaries
-	if (ilen < MIN_PAYLOAD_SIZE || ilen > MAX_PAYLOAD_SIZE)
-		return RPC_ERROR;
+	return rpc_link_send_frame(frame, len);
+}
 
-	 uint8_t t = in[0];
-	 uint8_t s = in[1];
 
-	 // Valid message types
-	if (t != MSG_REQ && t != MSG_RESP && t != MSG_ERR && t != MSG_STREAM)
-		return RPC_ERROR;
+/**
+ * @brief Whether a request fits in a payload, deadline budget included.
+ *
+ * Checked before a waiter is taken and its deadline armed, so a request
+ * that can never be sent does not race with its own timeout.
+ *
+ * @param name Function name.
+ * @param alen Length of arguments.
+ */
+static bool rpc_trans_req_fits(const char* name, uint16_t alen)
+{
+	size_t need = TYPE_MSG_SIZE + SEQ_MSG_SIZE + alen + (RPC_DEADLINE_BUDGET ? BUDGET_MSG_SIZE : 0) +
+	              (rpc_trans_method_id(name) ? METHOD_ID_SIZE : strlen(name) + TERM_SIZE);
+	return need <= MAX_PAYLOAD_SIZE;
+}
+
+
+/**
+ * @brief Serialize a message and hand it to the link layer for sending.
+ *
+ * The threaded runtime serializes it straight into a transport-to-link
+ * ring record of exactly the message size plus the link framing room, for
+ * the TX thread to frame in place; the reactor runtime frames and writes
+ * it from the stack in the calling thread.
+ *
+ * @param type Message type (MSG_REQ, MSG_RESP, MSG_ERR, MSG_STREAM).
+ * @param seq Sequence number.
+ * @param name Function name.
+ * @param id Method ID, 0 to send the name.
+ * @param budget Caller's remaining time in milliseconds, 0 to send none.
+ * @param args Pointer to arguments buffer.
+ * @param alen Length of arguments.
+ * @param wait Longest wait for ring space (threaded runtime).
+ * @return RPC_SUCCESS on success, RPC_ERROR otherwise (also if the ring
+ *         stayed full for @p wait).
+ */
+static int rpc_trans_post_msg(uint8_t type, uint32_t seq, const char* name, uint16_t id,
+                              uint16_t budget, const uint8_t* args, uint16_t alen,
+                              uint32_t wait)
+{
+	size_t need = TYPE_MSG_SIZE + SEQ_MSG_SIZE + alen + (budget ? BUDGET_MSG_SIZE : 0) +
+	              (id ? METHOD_ID_SIZE : strlen(name) + TERM_SIZE);
+	if (need > MAX_PAYLOAD_SIZE) return RPC_ERROR;
+
+	if (s_runtime == RPC_RUNTIME_REACTOR) {
+		os_mutex_lock(s_tx_mtx);
+		int rc = rpc_trans_write_msg(type, seq, name, id, budget, args, alen);
+		os_mutex_unlock(s_tx_mtx);
+		return rc;
+	}
+
+	uint8_t* frame = os_ring_reserve(qTransToLink, LINK_HEADROOM + need + LINK_TAILROOM, wait);
+	if (!frame) return RPC_ERROR;
+
+	size_t len = rpc_trans_build_msg(type, seq, name, id, budget, args, alen,
+	                                 frame + LINK_HEADROOM, need);
+	os_ring_commit(qTransToLink, frame, len ? LINK_HEADROOM + len + LINK_TAILROOM : 0);
+	return len ? RPC_SUCCESS : RPC_ERROR;
+}
+
+
+/**
+ * @brief Serialize a message and hand it to the link layer, waiting for
+ *        ring space as long as needed.
+ *
+ * @see rpc_trans_post_msg()
+ */
+static int rpc_trans_send_msg(uint8_t type, uint32_t seq, const char* name, uint16_t id,
+                              uint16_t budget, const uint8_t* args, uint16_t alen)
+{
+	return rpc_trans_post_msg(type, seq, name, id, budget, args, alen, OS_WAIT_FOREVER);
+}
+
+
+/**
+ * @brief Parse a transport message.
+ *
+ * @param in Input buffer.
+ * @param ilen Input length.
+ * @param type Output: message type (without MSG_ID_FLAG).
+ * @param seq Output: sequence number.
+ * @param name Output: pointer to function name (the method table's for a
+ *             message with a method ID, "?" if the ID is unknown).
+ * @param id Output: method ID, 0 if the message carries the name.
+ * @param budget Output: caller's remaining time in milliseconds, 0 if none.
+ * @param args Output: pointer to arguments.
+ * @param alen Output: arguments length.
+ * @return RPC_SUCCESS on success, RPC_ERROR otherwise.
+ */
+static int rpc_trans_parse_msg(const uint8_t* in, size_t ilen,
+					           uint8_t* type, uint32_t* seq,
+					           const char** name, uint16_t* id, uint16_t* budget,
+					           const uint8_t** args, uint16_t* alen)
+{
+	// Checking pointers
+	if (!in || !type || !seq || !name || !id || !budget || !args || !alen)
+		return RPC_ERROR;
+
+	// Payload Boundaries
+	if (ilen < MIN_PAYLOAD_SIZE || ilen > MAX_PAYLOAD_SIZE)
+		return RPC_ERROR;
+
+	 uint8_t t = in[0] & (uint8_t)~(MSG_ID_FLAG | MSG_BUDGET_FLAG);
+	 uint32_t s = rpc_trans_get_seq(&in[TYPE_MSG_SIZE]);
+
+	 // Valid message types
+	if (t != MSG_REQ && t != MSG_RESP && t != MSG_ERR && t != MSG_STREAM)
+		return RPC_ERROR;
 
 	*type = t;
 	*seq  = s;
+	*id   = 0;
+	*budget = 0;
+
+	// Deadline budget after the sequence number (MIN_PAYLOAD_SIZE covers it)
+	size_t name_start = TYPE_MSG_SIZE + SEQ_MSG_SIZE;
+	if (in[0] & MSG_BUDGET_FLAG) {
+		const uint8_t* f = &in[name_start];
+		*budget = (uint16_t)(f[0] | (f[1] << 8));
+		name_start += BUDGET_MSG_SIZE;
+	}
+
+	// Method ID in place of the name
+	if (in[0] & MSG_ID_FLAG) {
+		const size_t i = name_start + METHOD_ID_SIZE;
+		if (i > ilen)
+			return RPC_ERROR;
+
+		const uint8_t* f = &in[name_start];
+		uint16_t m = (uint16_t)(f[0] | (f[1] << 8));
+		if (m == 0 || ilen - i > MAX_FUNC_ARGS_RESP_SIZE)
+			return RPC_ERROR;
+
+		*id   = m;
+		*name = (m < RPC_METHOD_ID_MAX && s_method[m].name) ? s_method[m].name : "?";
+		*alen = (uint16_t)(ilen - i);
+		*args = &in[i];
+		return RPC_SUCCESS;
+	}
 
-	// Function name starts with offset=2
-	const size_t name_start = 2;
+	// Function name follows type, sequence number and budget
 	if (name_start >= ilen)
 		return RPC_ERROR;
 
@@ -241,129 +942,1250 @@ static int rpc_trans_parse_msg(const uint8_t* in, size_t ilen,
 }
 
 
+/**
+ * @brief Deadline budget sent with a request: milliseconds left until
+ *        @p deadline_ms.
+ *
+ * @return 1..UINT16_MAX, or 0 to send none (RPC_DEADLINE_BUDGET off, or
+ *         more time left than the field holds).
+ */
+static uint16_t rpc_trans_budget(uint64_t deadline_ms)
+{
+	if (!RPC_DEADLINE_BUDGET) return 0;
+
+	uint64_t now = os_time_ms();
+	if (now >= deadline_ms) return 1; // Already late: the peer sheds it
+	return (deadline_ms - now > UINT16_MAX) ? 0 : (uint16_t)(deadline_ms - now);
+}
+
+
+/**
+ * @brief Milliseconds left until @p end_ms (UINT64_MAX: no end).
+ */
+static uint32_t rpc_trans_left_ms(uint64_t end_ms)
+{
+	if (end_ms == UINT64_MAX) return OS_WAIT_FOREVER;
+
+	uint64_t now = os_time_ms();
+	return (now >= end_ms) ? 0 : (uint32_t)(end_ms - now);
+}
+
+
+/**
+ * @brief End time of a wait of @p timeout_ms from now (UINT64_MAX: no end).
+ */
+static uint64_t rpc_trans_end_ms(uint32_t timeout_ms)
+{
+	return (timeout_ms == OS_WAIT_FOREVER) ? UINT64_MAX : os_time_ms() + timeout_ms;
+}
+
+
+/**
+ * @brief Add a chunk of REQ_TABLE_SIZE waiters to the table (under s_wait_mtx).
+ *
+ * @return true on success, false at the size limit or out of memory.
+ */
+static bool rpc_trans_grow_waiters(void)
+{
+	if (s_wait_chunks >= s_wait_chunks_max) return false;
+
+	waiter_t* chunk = os_mem_alloc(REQ_TABLE_SIZE * sizeof(*chunk));
+	if (!chunk) return false;
+
+	for (uint32_t i = 0; i < REQ_TABLE_SIZE; i++) {
+		waiter_t* w = &chunk[i];
+		w->index = (uint32_t)(s_wait_chunks * REQ_TABLE_SIZE + i);
+		w->done = os_sem_create_binary();
+		atomic_init(&w->wake, w->done);
+		os_wtimer_init(&w->timer, rpc_trans_on_timeout, w);
+	}
+
+	// Published before its indices become free, so a response finds it
+	atomic_store_explicit(&s_wait[s_wait_chunks], chunk, memory_order_release);
+	for (uint32_t i = 0; i < REQ_TABLE_SIZE; i++)
+		os_queue_send(qFreeWaiters, &chunk[i].index, OS_NO_WAIT);
+	s_wait_chunks++;
+
+	RPC_LOG_INFO("Waiter table grown to %zu waiters", s_wait_chunks * REQ_TABLE_SIZE);
+	return true;
+}
+
+
 /**
  * @brief Initialize waiter structures.
+ *
+ * The table starts with REQ_TABLE_SIZE waiters and grows up to
+ * RPC_WAITER_MAX, except in arena mode, where nothing is allocated after
+ * start: the table is created at its full size, RPC_ARENA_WAITERS.
  */
 static void rpc_trans_init_waiter(void) {
-	s_wait_mtx = os_mutex_create();
+	_Static_assert(RPC_ARENA_WAITERS % REQ_TABLE_SIZE == 0 && RPC_ARENA_WAITERS <= RPC_WAITER_MAX,
+	               "RPC_ARENA_WAITERS must be a multiple of REQ_TABLE_SIZE up to RPC_WAITER_MAX");
+
+	bool arena = os_arena_used() != 0;
+	s_wait_mtx = rpc_trans_mutex_create();
+	s_wait_chunks_max = (arena ? RPC_ARENA_WAITERS : RPC_WAITER_MAX) / REQ_TABLE_SIZE;
+	qFreeWaiters = os_mpmc_queue_create(s_wait_chunks_max * REQ_TABLE_SIZE, sizeof(uint32_t));
+	for (s_park_sem_n = 0; s_park_sem_n < RPC_WAITER_PARK_MAX; s_park_sem_n++)
+		s_park_sem[s_park_sem_n] = os_sem_create_binary();
+
+	os_mutex_lock(s_wait_mtx);
+	while (rpc_trans_grow_waiters() && arena) {}
+	os_mutex_unlock(s_wait_mtx);
+}
+
+
+/**
+ * @brief Most waiters the table can hold (requests in flight at once).
+ */
+static size_t rpc_trans_waiter_capacity(void)
+{
+	return s_wait_chunks_max * REQ_TABLE_SIZE;
+}
+
+
+/**
+ * @brief Waiter at a table index.
+ *
+ * @param index Table index (sequence number & (RPC_WAITER_MAX - 1)).
+ * @return Waiter, NULL if the table has not grown that far.
+ */
+static waiter_t* rpc_trans_waiter_at(uint32_t index)
+{
+	waiter_t* chunk = atomic_load_explicit(&s_wait[index / REQ_TABLE_SIZE], memory_order_acquire);
+	return chunk ? &chunk[index % REQ_TABLE_SIZE] : NULL;
+}
+
+
+/**
+ * @brief Take a free waiter, growing the table when none is left.
+ *
+ * @param index Output: table index of the waiter.
+ * @return true on success, false if none is free at the size limit.
+ */
+static bool rpc_trans_take_free(uint32_t* index)
+{
+	while (os_queue_recv(qFreeWaiters, index, OS_NO_WAIT) != OS_TRUE) {
+		os_mutex_lock(s_wait_mtx);
+		bool grown = rpc_trans_grow_waiters();
+		os_mutex_unlock(s_wait_mtx);
+
+		if (!grown) return false;
+	}
+	return true;
+}
+
+
+/**
+ * @brief Hand free waiters to queued callers, oldest first (under s_wait_mtx).
+ */
+static void rpc_trans_serve_parked(void)
+{
+	uint32_t index;
+
+	while (s_park_head && os_queue_recv(qFreeWaiters, &index, OS_NO_WAIT) == OS_TRUE) {
+		park_t* p = s_park_head;
+		s_park_head = p->next;
+		if (!s_park_head) s_park_tail = &s_park_head;
+		p->index = index;
+		os_sem_give(p->sem);
+	}
+}
+
+
+/**
+ * @brief Queue up for the next freed waiter.
+ *
+ * Callers are served in arrival order: a waiter freed while any caller is
+ * queued goes to the oldest one. Each queued caller sleeps on a parking
+ * semaphore of its own; with all RPC_WAITER_PARK_MAX in use, further
+ * callers wait on the free queue directly, in no particular order.
+ *
+ * @param index Output: table index of the waiter.
+ * @param deadline_ms Give up at this os_time_ms() time.
+ * @return true if a waiter was obtained.
+ */
+static bool rpc_trans_park_for_waiter(uint32_t* index, uint64_t deadline_ms)
+{
+	park_t me = { .next = NULL, .index = PARK_NONE };
+
+	os_mutex_lock(s_wait_mtx);
+	if (!s_park_sem_n) {
+		os_mutex_unlock(s_wait_mtx);
+		return os_queue_recv(qFreeWaiters, index, rpc_trans_left_ms(deadline_ms)) == OS_TRUE;
+	}
+
+	me.sem = s_park_sem[--s_park_sem_n];
+	*s_park_tail = &me;
+	s_park_tail = &me.next;
+
+	// Announced before the free queue is checked again: a waiter freed
+	// concurrently is either seen here or handed over by its freer
+	atomic_fetch_add(&s_parked, 1);
+	atomic_thread_fence(memory_order_seq_cst);
+	rpc_trans_serve_parked();
+
+	while (me.index == PARK_NONE) {
+		uint32_t left = rpc_trans_left_ms(deadline_ms);
+		if (left == 0) break;
+
+		os_mutex_unlock(s_wait_mtx);
+		os_sem_take(me.sem, left);
+		os_mutex_lock(s_wait_mtx);
+	}
 
-	for (int i = 0; i < REQ_TABLE_SIZE; i++) {
-		s_wait[i].in_use = false;
-		s_wait[i].done = os_sem_create_binary();
+	if (me.index == PARK_NONE) {
+		// Timed out: leave the queue
+		park_t** pp = &s_park_head;
+		while (*pp != &me) pp = &(*pp)->next;
+		*pp = me.next;
+		if (!me.next) s_park_tail = pp;
+	} else {
+		os_sem_take(me.sem, OS_NO_WAIT); // Hand-over token, if not consumed above
 	}
+	atomic_fetch_sub(&s_parked, 1);
+	s_park_sem[s_park_sem_n++] = me.sem;
+	os_mutex_unlock(s_wait_mtx);
+
+	*index = me.index;
+	return me.index != PARK_NONE;
 }
 
 
 /**
  * @brief Allocate a waiter for new request.
  *
+ * Takes a free waiter, growing the table when none is left; at the size
+ * limit it queues for one to be freed, behind callers already queued.
+ *
  * @param out_seq Pointer to store allocated sequence number.
  * @param out_w Pointer to store waiter reference.
+ * @param deadline_ms os_time_ms() time to wait for a free waiter until,
+ *        0 not to wait.
  * @return RPC_SUCCESS on success, RPC_ERROR otherwise.
  */
-static int rpc_trans_alloc_waiter(uint8_t* out_seq, waiter_t** out_w)
+static int rpc_trans_alloc_waiter(uint32_t* out_seq, waiter_t** out_w, uint64_t deadline_ms)
+{
+	uint32_t index;
+
+	// No overtaking of queued callers
+	bool queued = atomic_load(&s_parked) != 0;
+	if (queued || !rpc_trans_take_free(&index)) {
+		if (!deadline_ms || !rpc_trans_park_for_waiter(&index, deadline_ms)) return RPC_ERROR;
+	}
+
+	// Sequence number 0 is left to streams
+	waiter_t* w = rpc_trans_waiter_at(index);
+	do {
+		w->gen++;
+		w->seq = index + w->gen * RPC_WAITER_MAX;
+	} while (w->seq == 0);
+
+	w->kind = WAIT_SYNC;
+	os_sem_take(w->done, OS_NO_WAIT); // No wakeup left from the previous request
+	atomic_store_explicit(&w->fstate, 0, memory_order_relaxed);
+	atomic_store_explicit(&w->pending, w->seq, memory_order_release);
+
+	*out_seq = w->seq;
+	*out_w = w;
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief Claim a pending waiter for resolution.
+ *
+ * Exactly one claim succeeds per request, so a response racing with the
+ * request's deadline timer resolves it only once.
+ *
+ * @param w Waiter.
+ * @param seq Sequence number the claim is for.
+ * @return true if claimed.
+ */
+static bool rpc_trans_claim_waiter(waiter_t* w, uint32_t seq)
+{
+	uint32_t expected = seq;
+	return atomic_compare_exchange_strong_explicit(&w->pending, &expected, 0,
+	                                               memory_order_acq_rel, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Find a pending waiter by sequence number and claim it for resolution.
+ *
+ * @param seq Sequence number.
+ * @return Pointer to waiter or NULL if not found.
+ */
+static waiter_t* rpc_trans_find_waiter(uint32_t seq)
+{
+	waiter_t* w = rpc_trans_waiter_at(seq & (RPC_WAITER_MAX - 1));
+	return (w && seq && rpc_trans_claim_waiter(w, seq)) ? w : NULL;
+}
+
+
+/**
+ * @brief Free waiter after completion.
+ *
+ * Stops its deadline timer first (waiting out a running expiry callback),
+ * so the slot cannot be timed out again once reused.
+ *
+ * @param w Waiter pointer.
+ */
+static void rpc_trans_free_waiter(waiter_t* w)
 {
-	static uint8_t s_next_seq = 1;
+	if (!w) return;
+
+	os_wtimer_cancel(s_timers, &w->timer);
+	atomic_store_explicit(&w->pending, 0, memory_order_relaxed); // Still set if never sent
+	os_queue_send(qFreeWaiters, &w->index, OS_NO_WAIT);
 
-	for (int attempt = 0; attempt < 255; attempt++) {
+	// Queued callers take it in arrival order
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load(&s_parked)) {
 		os_mutex_lock(s_wait_mtx);
+		rpc_trans_serve_parked();
+		os_mutex_unlock(s_wait_mtx);
+	}
+}
 
-		uint8_t s = s_next_seq++;
-		if (s_next_seq == 0) s_next_seq = 1; // skip 0
-		for (int i = 0; i < REQ_TABLE_SIZE; i++) {
-			if (!s_wait[i].in_use) {
-				s_wait[i].in_use = true;
-				s_wait[i].seq = s;
-				*out_seq = s;
-				*out_w = &s_wait[i];
-				os_mutex_unlock(s_wait_mtx);
-				return RPC_SUCCESS;
-			}
+/**
+ * @brief Make s_poll_ev readable.
+ *
+ * Only the first notification after an rpc_poll() touches the descriptor.
+ */
+static void rpc_trans_poll_notify(void)
+{
+	if (!atomic_exchange(&s_poll_signalled, true)) os_event_signal(s_poll_ev);
+}
+
+
+/**
+ * @brief Run the completion callback of a resolved request and free its waiter.
+ *
+ * Task handed to the executor, or run by rpc_trans_poll().
+ *
+ * @param arg Waiter.
+ */
+static void rpc_trans_run_done(void* arg)
+{
+	waiter_t* w = arg;
+	uint16_t len = RPC_IS_SUCCESS(w->result_code) ? w->async_len : 0;
+
+	w->done_fn(w->result_code, w->async_resp, len, w->user);
+	rpc_trans_free_waiter(w);
+}
+
+
+/**
+ * @brief Free the waiter of a future once both sides are done with it.
+ *
+ * A wakeup left in its semaphore (no one waited, or it served a wait-any
+ * group) is taken first, so the next synchronous request through this
+ * waiter does not return before its response.
+ *
+ * @param w Waiter.
+ */
+static void rpc_trans_future_free(waiter_t* w)
+{
+	os_sem_take(w->done, OS_NO_WAIT);
+	rpc_trans_free_waiter(w);
+}
+
+
+/**
+ * @brief Hand a resolved waiter to whoever waits for it.
+ *
+ * Wakes the synchronous caller, the caller of a batch (once its last
+ * request resolves) or the waiter of a future (freeing the latter if
+ * already released), or hands the completion callback to the
+ * executor; without one it is queued for rpc_poll(). The completion queue
+ * holds a slot per waiter, so it never overflows.
+ *
+ * @param w Waiter, already claimed (no longer pending).
+ */
+static void rpc_trans_resolve(waiter_t* w)
+{
+	switch (w->kind) {
+	case WAIT_SYNC:
+		os_sem_give(w->done);
+		return;
+
+	case WAIT_BATCH: {
+		// The caller waits for this one give only, so the batch outlives it
+		batch_t* bt = w->batch;
+		if (atomic_fetch_sub(&bt->left, 1) == 1) os_sem_give(bt->done);
+		return;
+	}
+
+	case WAIT_FUTURE:
+		// Published before the wakeup target is read: a wait-any group that
+		// is installed meanwhile sees the future resolved (both seq_cst)
+		atomic_fetch_or(&w->fstate, FUT_RESOLVED);
+		os_sem_give(atomic_load(&w->wake));
+		if (atomic_fetch_or(&w->fstate, FUT_SIGNALLED) & FUT_RELEASED) rpc_trans_future_free(w);
+		return;
+
+	default:
+		if (s_exec.submit) {
+			s_exec.submit(rpc_trans_run_done, w, s_exec.ctx);
+			return;
 		}
+		os_queue_send(qPollDone, &w, OS_NO_WAIT);
+		rpc_trans_poll_notify();
+		return;
+	}
+}
 
-		os_mutex_unlock(s_wait_mtx);
-		os_delay_ms(1);
+
+/**
+ * @brief Request deadline timer callback: fail the request if still pending.
+ *
+ * Runs on the timer thread (or the reactor loop). The sequence number is
+ * remembered so a response arriving later is recognized and dropped.
+ *
+ * @param arg Waiter.
+ */
+static void rpc_trans_on_timeout(void* arg)
+{
+	waiter_t* w = arg;
+
+	if (rpc_trans_claim_waiter(w, w->seq)) {
+		atomic_store_explicit(&w->timed_out, w->seq, memory_order_relaxed);
+		w->result_code = RPC_ERROR_TIMEOUT;
+		rpc_trans_resolve(w);
+	}
+}
+
+
+/**
+ * @brief Check whether a response without waiter answers a timed-out request.
+ */
+static bool rpc_trans_is_late_response(uint32_t seq)
+{
+	waiter_t* w = rpc_trans_waiter_at(seq & (RPC_WAITER_MAX - 1));
+	return w && seq && atomic_load_explicit(&w->timed_out, memory_order_relaxed) == seq;
+}
+
+
+/**
+ * @brief Timer wheel serving request and handler deadlines.
+ */
+os_twheel_t rpc_trans_timers(void)
+{
+	return s_timers;
+}
+
+
+/**
+ * @brief Request queues of a dispatch class: one, or one per worker with
+ *        work stealing (which a single worker has no use for).
+ */
+static size_t rpc_trans_class_queues(size_t workers, rpc_sched_t sched)
+{
+	return (sched == RPC_SCHED_STEAL && workers > 1) ? workers : 1;
+}
+
+
+/**
+ * @brief Create the request queue(s) and worker slots of a dispatch class.
+ *
+ * @param c Class index.
+ * @param cfg Class configuration (zero fields take the defaults).
+ * @return RPC_SUCCESS on success, RPC_ERROR if out of memory.
+ */
+static int rpc_trans_class_create(size_t c, const rpc_class_cfg_t* cfg)
+{
+	dclass_t* k = &s_class[c];
+
+	k->cfg = *cfg;
+	if (!k->cfg.workers) k->cfg.workers = 1;
+	if (k->cfg.max_workers < k->cfg.workers) k->cfg.max_workers = k->cfg.workers;
+	if (!k->cfg.queue_depth) k->cfg.queue_depth = Q_RPC_REQUEST_DEPTH;
+	k->elastic = k->cfg.max_workers > k->cfg.workers;
+	k->steal = !k->elastic && rpc_trans_class_queues(k->cfg.workers, s_sched) > 1;
+	k->w = os_mem_alloc(k->cfg.max_workers * sizeof(*k->w));
+	if (!k->w) return RPC_ERROR;
+
+	// The default class keeps the queue name it always had
+	if (c == 0) snprintf(k->qname, sizeof(k->qname), "rpc_requests");
+	else snprintf(k->qname, sizeof(k->qname), "rpc_requests.%s", k->cfg.name);
+
+	if (!k->steal) {
+		// Transport thread is the only producer; SPSC only while there is one worker
+		k->q = (k->cfg.max_workers == 1)
+				? os_spsc_queue_create(k->cfg.queue_depth, sizeof(rpc_request_t))
+				: os_mpmc_queue_create(k->cfg.queue_depth, sizeof(rpc_request_t));
+		if (!k->q) return RPC_ERROR;
+		os_queue_set_name(k->q, k->qname);
+	}
+
+	for (uint8_t i = 0; i < k->cfg.max_workers; i++) {
+		worker_t* w = &k->w[i];
+		w->k = k;
+		w->index = i;
+		w->q = k->q;
+		if (!k->steal) continue;
+
+		// One producer, the owner and the thieves consume
+		w->q = os_mpmc_queue_create(k->cfg.queue_depth, sizeof(rpc_request_t));
+		if (!w->q) return RPC_ERROR;
+		snprintf(w->qname, sizeof(w->qname), "%s/%u", k->qname, i);
+		os_queue_set_name(w->q, w->qname);
+	}
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize the RPC transport layer.
+ *
+ * Creates mutexes, initializes waiter table, and creates inter-layer queues.
+ */
+void rpc_trans_init(rpc_runtime_t runtime, bool poll_streams, rpc_sched_t sched)
+{
+	s_runtime = runtime;
+	s_poll_streams = poll_streams;
+	s_sched = sched;
+	s_tx_mtx = rpc_trans_mutex_create();
+	s_worker_count = rpc_trans_mutex_create();
+	s_reg_mtx = rpc_trans_mutex_create();
+	s_timers = os_twheel_create(RPC_TIMER_TICK_MS);
+	rpc_trans_init_waiter();
+
+	os_mutex_set_name(s_tx_mtx, "tx_mtx");
+	os_mutex_set_name(s_worker_count, "worker_count");
+	os_mutex_set_name(s_reg_mtx, "reg_mtx");
+	os_mutex_set_name(s_wait_mtx, "wait_mtx");
+	os_twheel_set_name(s_timers, "timer_wheel");
+
+	// Inter-layer byte rings hold the payloads themselves, each record sized
+	// to its message, so their memory follows the bytes in flight
+	qLinkToTrans = os_ring_create(Q_LINK_TO_TRANS_BYTES);
+
+	// Every client thread and every worker produces requests/responses
+	qTransToLink = os_ring_create(Q_TRANS_TO_LINK_BYTES);
+
+	os_queue_set_name(qLinkToTrans, "link_to_trans");
+	os_queue_set_name(qTransToLink, "trans_to_link");
+
+	const rpc_class_cfg_t dflt = {
+		.name        = "default",
+		.workers     = RPC_WORKER_COUNT,
+		.max_workers = RPC_WORKER_MAX,
+		.queue_depth = Q_RPC_REQUEST_DEPTH,
+		.policy      = RPC_THREAD_WORKER_POLICY,
+		.priority    = RPC_THREAD_WORKER_PRIORITY,
+		.cpu_mask    = RPC_THREAD_WORKER_CPU_MASK,
+	};
+	rpc_trans_class_create(0, &dflt);
+	s_class_count = 1;
+
+	// Completions come from the transport and timer threads (or the event
+	// loop) and may be polled from any thread
+	s_poll_ev = os_event_create();
+	qPollDone = os_mpmc_queue_create(s_wait_chunks_max * REQ_TABLE_SIZE, sizeof(waiter_t*));
+	qPollStreams = os_mpmc_queue_create(Q_RPC_REQUEST_DEPTH, sizeof(rpc_request_t));
+	os_queue_set_name(qPollDone, "poll_done");
+	os_queue_set_name(qPollStreams, "poll_streams");
+}
+
+
+/**
+ * @brief Create the dispatch classes after the default one.
+ */
+int rpc_trans_set_classes(const rpc_class_cfg_t* classes, size_t count)
+{
+	if (count && !classes) return RPC_ERROR_INVALID_ARGS;
+	if (s_class_count + count > RPC_CLASS_MAX) {
+		RPC_LOG_ERROR("Too many dispatch classes: %zu (max %u)", s_class_count + count,
+		              (unsigned)RPC_CLASS_MAX);
+		return RPC_ERROR_INVALID_ARGS;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (!classes[i].name) {
+			RPC_LOG_ERROR("Dispatch class %zu has no name", s_class_count + i);
+			return RPC_ERROR_INVALID_ARGS;
+		}
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (rpc_trans_class_create(s_class_count, &classes[i]) != RPC_SUCCESS) return RPC_ERROR;
+		s_class_count++;
+	}
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief Name of the request queue of a dispatch class.
+ */
+const char* rpc_trans_class_queue(uint8_t cls)
+{
+	return (cls < s_class_count) ? s_class[cls].qname : NULL;
+}
+
+
+/**
+ * @brief Set the executor of asynchronous completion callbacks.
+ */
+void rpc_trans_set_executor(const rpc_executor_t* exec)
+{
+	s_exec = exec ? *exec : (rpc_executor_t){ 0 };
+}
+
+
+/**
+ * @brief Set the default response wait strategy of synchronous requests.
+ */
+void rpc_trans_set_wait(rpc_wait_t wait, uint32_t spin_max_us)
+{
+	s_wait_mode = wait;
+	s_spin_max_ns = spin_max_us * 1000u;
+}
+
+
+/**
+ * @brief OSAL arena bytes needed by the transport layer.
+ *
+ * Mutexes (TX, worker count, registry, waiters), the timer wheel, the
+ * waiter table with one semaphore per waiter and per parking slot, the
+ * free waiter queue (the table does not grow in arena mode), the registry
+ * table for NUM_REG_FUNC functions, the two inter-layer rings, the poll
+ * event and its two queues, the transport and timer threads, and the
+ * request queue(s), worker slots and worker threads of every dispatch class.
+ */
+size_t rpc_trans_arena_size(const rpc_class_cfg_t* classes, size_t class_count,
+                            rpc_sched_t sched)
+{
+	// Default class, then the configured ones
+	size_t cls = ((RPC_WORKER_MAX > RPC_WORKER_COUNT) ? 1 : rpc_trans_class_queues(RPC_WORKER_COUNT, sched)) *
+	             os_arena_footprint(OS_OBJ_QUEUE, Q_RPC_REQUEST_DEPTH, sizeof(rpc_request_t)) +
+	             os_arena_footprint(OS_OBJ_MEM, RPC_WORKER_MAX * sizeof(worker_t), 0) +
+	             RPC_WORKER_MAX * os_arena_footprint(OS_OBJ_THREAD, 0, 0);
+	for (size_t i = 0; classes && i < class_count; i++) {
+		size_t depth = classes[i].queue_depth ? classes[i].queue_depth : Q_RPC_REQUEST_DEPTH;
+		size_t workers = classes[i].workers ? classes[i].workers : 1;
+		size_t max = (classes[i].max_workers > workers) ? classes[i].max_workers : workers;
+		// An elastic class shares one queue and runs at its maximum in arena mode
+		cls += ((max > workers) ? 1 : rpc_trans_class_queues(workers, sched)) *
+		       os_arena_footprint(OS_OBJ_QUEUE, depth, sizeof(rpc_request_t)) +
+		       os_arena_footprint(OS_OBJ_MEM, max * sizeof(worker_t), 0) +
+		       max * os_arena_footprint(OS_OBJ_THREAD, 0, 0);
+	}
+
+	return cls +
+	       4 * os_arena_footprint(OS_OBJ_MUTEX, 0, 0) +
+	       os_arena_footprint(OS_OBJ_TWHEEL, 0, 0) +
+	       RPC_ARENA_WAITERS / REQ_TABLE_SIZE * os_arena_footprint(OS_OBJ_MEM, REQ_TABLE_SIZE * sizeof(waiter_t), 0) +
+	       (RPC_ARENA_WAITERS + RPC_WAITER_PARK_MAX) * os_arena_footprint(OS_OBJ_SEM, 0, 0) +
+	       os_arena_footprint(OS_OBJ_QUEUE, RPC_ARENA_WAITERS, sizeof(uint32_t)) +
+	       os_arena_footprint(OS_OBJ_MEM, sizeof(reg_table_t) + reg_table_slots(NULL) * sizeof(reg_entry_t), 0) +
+	       os_arena_footprint(OS_OBJ_RING, Q_LINK_TO_TRANS_BYTES, 0) +
+	       os_arena_footprint(OS_OBJ_RING, Q_TRANS_TO_LINK_BYTES, 0) +
+	       os_arena_footprint(OS_OBJ_EVENT, 0, 0) +
+	       os_arena_footprint(OS_OBJ_QUEUE, RPC_ARENA_WAITERS, sizeof(waiter_t*)) +
+	       os_arena_footprint(OS_OBJ_QUEUE, Q_RPC_REQUEST_DEPTH, sizeof(rpc_request_t)) +
+	       2 * os_arena_footprint(OS_OBJ_THREAD, 0, 0);
+}
+
+
+/**
+ * @brief Send an RPC request and wait for response.
+ *
+ * @param name Function name to call.
+ * @param args Arguments buffer.
+ * @param args_len Arguments length.
+ * @param resp_buf Response buffer.
+ * @param resp_len Response length (input: capacity, output: actual length).
+ * @param timeout_ms Timeout in milliseconds.
+ * @param opts Call options, NULL for the defaults.
+ * @return RPC_SUCCESS on success, error code on failure.
+ */
+int rpc_trans_request(const char* name,
+			 const void* args, uint16_t args_len,
+			 void* resp_buf, uint16_t* resp_len,
+			 uint32_t timeout_ms, const rpc_call_opts_t* opts)
+{
+    RPC_LOG_TRACE("RPC call started: %s, args_len: %u, timeout: %u ms",
+                  name ? name : "(null)", args_len, timeout_ms);
+
+    // Function name validation
+    if (!name) {
+        RPC_LOG_ERROR("RPC call failed: name is NULL");
+        return RPC_ERROR;
+    }
+
+    size_t nlen = strlen(name);
+    if (nlen < MIN_FUNC_NAME_LEN || nlen > MAX_FUNC_NAME_LEN) {
+        RPC_LOG_ERROR("Invalid RPC function name length: %zu", nlen);
+        return RPC_ERROR;
+    }
+
+    // Validate the response buffer
+    if (!resp_buf || !resp_len) {
+        RPC_LOG_ERROR("Invalid response buffer (NULL pointer), function: %s", name);
+        return RPC_ERROR;
+    }
+
+    if (*resp_len < MAX_FUNC_ARGS_RESP_SIZE) {
+        RPC_LOG_ERROR("Response buffer too small (%u < %u), function: %s",
+                      *resp_len, MAX_FUNC_ARGS_RESP_SIZE, name);
+        return RPC_ERROR;
+    }
+
+    if (!rpc_trans_req_fits(name, args_len)) {
+        RPC_LOG_ERROR("RPC request too large: %s, args_len: %u", name, args_len);
+        return RPC_ERROR_OVERFLOW;
+    }
+
+    // Allocate a waiter; time spent queued for one counts against the timeout
+	uint32_t actual_timeout = timeout_ms ? timeout_ms : REQ_TIMEOUT_MS_DEFAULT;
+	uint64_t deadline = os_time_ms() + actual_timeout;
+	uint32_t seq = 0;
+	waiter_t* w = NULL;
+	if (rpc_trans_alloc_waiter(&seq, &w, deadline) != 0) {
+		RPC_LOG_ERROR("No free waiters available for RPC call: %s", name);
+		return RPC_ERROR;
+	}
+	RPC_LOG_DEBUG("Allocated waiter, sequence: %u", seq);
+
+	// Initialize the waiter
+	w->resp_buf = (uint8_t*)resp_buf;
+	w->resp_len = resp_len;
+	w->resp_buf_cap = *resp_len;
+	w->rtt_tag = rpc_trans_rtt_tag(name);
+	w->sent_ns = os_time_ns();
+
+	// The timer wheel enforces the deadline, so the caller waits untimed
+	// and every request is resolved exactly once (response or timeout)
+	os_wtimer_start(s_timers, &w->timer, deadline);
+
+	// Forming a message and sending it to link layer
+	// A send failure loses to a deadline that already resolved the request:
+	// the wait below then takes the timeout
+	if (rpc_trans_send_msg(MSG_REQ, seq, name, rpc_trans_method_id(name), rpc_trans_budget(deadline),
+	                       (const uint8_t*)args, args_len) != RPC_SUCCESS &&
+	    rpc_trans_claim_waiter(w, seq)) {
+		RPC_LOG_ERROR("Failed to send message to link layer: %s, args_len: %u", name, args_len);
+		rpc_trans_free_waiter(w);
+		return RPC_ERROR;
+	}
+	RPC_LOG_TRACE("Message sent to link layer");
+
+	// Waiting for response: fast methods are caught spinning, saving the wakeup
+	RPC_LOG_DEBUG("Waiting for response, timeout: %u ms", actual_timeout);
+	uint32_t spin_ns = rpc_trans_spin_budget(w->rtt_tag, opts);
+	if (os_sem_take_spin(w->done, spin_ns, OS_WAIT_FOREVER) != OS_TRUE ||
+	    w->result_code == RPC_ERROR_TIMEOUT) {
+		RPC_LOG_ERROR("RPC call timeout: %s, sequence: %u, timeout: %u ms",
+				      name, seq, actual_timeout);
+		rpc_trans_free_waiter(w);
+		return RPC_ERROR;
+	}
+
+	// Read the result
+	int rc = w->result_code;
+
+	// Logging depending on the result
+    if (RPC_IS_SUCCESS(rc)) {
+        RPC_LOG_INFO("RPC call succeeded: %s, response length: %u\n",
+                    name, (resp_len && *resp_len) ? *resp_len : 0);
+    } else {
+        RPC_LOG_ERROR("RPC call failed: %s, error code: %d, response length: %u\n",
+                    name, rc, (resp_len && *resp_len) ? *resp_len : 0);
+    }
+
+	rpc_trans_free_waiter(w);
+	return rc;
+}
+
+
+/**
+ * @brief Send several requests back to back and wait once for all of them.
+ *
+ * Every request gets its waiter and deadline up front; the messages are
+ * then serialized one after the other (in the reactor runtime under a
+ * single hold of the TX mutex). Responses land straight in the entries'
+ * buffers, and only the last request to resolve wakes the caller.
+ * With all waiters in flight, entries queue for a free one until the
+ * batch deadline; entries that get none, or whose message cannot be
+ * built, fail on their own.
+ *
+ * @param e Calls (results are written back).
+ * @param n Number of calls, at most RPC_BATCH_MAX and the waiter table size.
+ * @param timeout_ms Deadline of the whole batch in milliseconds.
+ * @return RPC_SUCCESS if every call succeeded, otherwise the result of the
+ *         first failed one.
+ */
+int rpc_trans_request_batch(rpc_batch_entry_t* e, size_t n, uint32_t timeout_ms)
+{
+	waiter_t* ws[RPC_BATCH_MAX];
+	batch_t bt = { .done = NULL };
+	size_t sent = 0;
+
+	RPC_LOG_TRACE("RPC batch started: %zu calls, timeout: %u ms", n, timeout_ms);
+
+	// A batch holds its waiters until all are resolved: a larger one could
+	// only wait for itself
+	size_t max = RPC_BATCH_MAX < rpc_trans_waiter_capacity() ? RPC_BATCH_MAX : rpc_trans_waiter_capacity();
+	if (!e || n == 0 || n > max) {
+		RPC_LOG_ERROR("Invalid RPC batch: %zu calls (max %zu)", n, max);
+		return RPC_ERROR_INVALID_ARGS;
+	}
+
+	uint32_t actual_timeout = timeout_ms ? timeout_ms : REQ_TIMEOUT_MS_DEFAULT;
+	uint64_t deadline = os_time_ms() + actual_timeout;
+
+	// Waiters first, so the count is final before any response can arrive
+	for (size_t i = 0; i < n; i++) {
+		uint32_t seq;
+		size_t nlen = e[i].name ? strlen(e[i].name) : 0;
+
+		ws[i] = NULL;
+		e[i].rc = RPC_ERROR;
+		if (nlen < MIN_FUNC_NAME_LEN || nlen > MAX_FUNC_NAME_LEN ||
+		    (e[i].resp_len && !e[i].resp_buf) || !rpc_trans_req_fits(e[i].name, e[i].args_len)) {
+			RPC_LOG_ERROR("Invalid RPC batch entry %zu", i);
+			e[i].resp_len = 0;
+			continue;
+		}
+		if (rpc_trans_alloc_waiter(&seq, &ws[i], deadline) != RPC_SUCCESS) {
+			RPC_LOG_ERROR("No free waiters available for RPC call: %s", e[i].name);
+			e[i].resp_len = 0;
+			continue;
+		}
+
+		waiter_t* w = ws[i];
+		w->kind = WAIT_BATCH;
+		w->batch = &bt;
+		w->resp_buf = (uint8_t*)e[i].resp_buf;
+		w->resp_len = &e[i].resp_len;
+		w->resp_buf_cap = e[i].resp_len;
+		w->rtt_tag = rpc_trans_rtt_tag(e[i].name);
+		if (!bt.done) bt.done = w->done;
+		sent++;
+	}
+	if (!sent) return RPC_ERROR;
+	atomic_store(&bt.left, sent);
+
+	for (size_t i = 0; i < n; i++)
+		if (ws[i]) os_wtimer_start(s_timers, &ws[i]->timer, deadline);
+
+	// Messages back to back; one that cannot be sent fails in place
+	if (s_runtime == RPC_RUNTIME_REACTOR) os_mutex_lock(s_tx_mtx);
+	for (size_t i = 0; i < n; i++) {
+		waiter_t* w = ws[i];
+		if (!w) continue;
+
+		w->sent_ns = os_time_ns();
+		uint16_t id = rpc_trans_method_id(e[i].name);
+		uint16_t budget = rpc_trans_budget(deadline);
+		int rc = (s_runtime == RPC_RUNTIME_REACTOR)
+				? rpc_trans_write_msg(MSG_REQ, w->seq, e[i].name, id, budget, e[i].args, e[i].args_len)
+				: rpc_trans_send_msg(MSG_REQ, w->seq, e[i].name, id, budget, e[i].args, e[i].args_len);
+		if (rc != RPC_SUCCESS && rpc_trans_claim_waiter(w, w->seq)) {
+			RPC_LOG_ERROR("Failed to send message to link layer: %s, args_len: %u",
+			              e[i].name, e[i].args_len);
+			w->result_code = RPC_ERROR;
+			*w->resp_len = 0;
+			rpc_trans_resolve(w);
+		}
+	}
+	if (s_runtime == RPC_RUNTIME_REACTOR) os_mutex_unlock(s_tx_mtx);
+
+	// Deadline timers resolve whatever is left, so one untimed wait suffices
+	os_sem_take(bt.done, OS_WAIT_FOREVER);
+
+	int first = RPC_SUCCESS;
+	for (size_t i = 0; i < n; i++) {
+		waiter_t* w = ws[i];
+		if (w) {
+			e[i].rc = w->result_code;
+			if (e[i].rc == RPC_ERROR_TIMEOUT) e[i].resp_len = 0;
+			rpc_trans_free_waiter(w);
+		}
+		if (RPC_IS_ERROR(e[i].rc) && first == RPC_SUCCESS) first = e[i].rc;
+	}
+
+	RPC_LOG_DEBUG("RPC batch done: %zu calls, %zu sent, result: %d", n, sent, first);
+	return first;
+}
+
+
+/**
+ * @brief Send a request whose outcome is stored in its waiter.
+ *
+ * Never waits for a free waiter: with all of them busy the call fails at
+ * once with RPC_ERROR_BUSY. Waiting could deadlock, since the caller may
+ * be the thread that frees them (an inline callback in the transport
+ * thread or reactor loop, or a thread holding the futures in flight).
+ * The waiter is set up for @p kind before the request leaves, since the
+ * response may be handled before this function returns.
+ *
+ * @param name Function name to call.
+ * @param args Arguments buffer.
+ * @param args_len Arguments length.
+ * @param timeout_ms Timeout in milliseconds.
+ * @param kind WAIT_CALLBACK or WAIT_FUTURE.
+ * @param done Completion callback (WAIT_CALLBACK).
+ * @param user Argument of @p done.
+ * @param out_w Waiter of the request.
+ * @return RPC_SUCCESS if the request was sent, error code otherwise
+ *         (the waiter is then freed again).
+ */
+static int rpc_trans_send_async(const char* name,
+                                const void* args, uint16_t args_len,
+                                uint32_t timeout_ms, wait_kind_t kind,
+                                rpc_done_fn done, void* user, waiter_t** out_w)
+{
+    RPC_LOG_TRACE("RPC async call started: %s, args_len: %u, timeout: %u ms",
+                  name ? name : "(null)", args_len, timeout_ms);
+
+    if (!name) {
+        RPC_LOG_ERROR("RPC async call failed: name is NULL");
+        return RPC_ERROR;
+    }
+
+    size_t nlen = strlen(name);
+    if (nlen < MIN_FUNC_NAME_LEN || nlen > MAX_FUNC_NAME_LEN) {
+        RPC_LOG_ERROR("Invalid RPC function name length: %zu", nlen);
+        return RPC_ERROR;
+    }
+
+    if (!rpc_trans_req_fits(name, args_len)) {
+        RPC_LOG_ERROR("RPC request too large: %s, args_len: %u", name, args_len);
+        return RPC_ERROR_OVERFLOW;
+    }
+
+	uint32_t seq = 0;
+	waiter_t* w = NULL;
+	if (rpc_trans_alloc_waiter(&seq, &w, 0) != 0) {
+		RPC_LOG_ERROR("No free waiters available for RPC call: %s", name);
+		return RPC_ERROR_BUSY;
+	}
+
+	// The response lands in the waiter itself
+	w->kind = (uint8_t)kind;
+	w->done_fn = done;
+	w->user = user;
+	w->async_len = 0;
+	w->resp_buf = w->async_resp;
+	w->resp_len = &w->async_len;
+	w->resp_buf_cap = sizeof(w->async_resp);
+	w->rtt_tag = rpc_trans_rtt_tag(name);
+	w->sent_ns = os_time_ns();
+
+	uint32_t actual_timeout = timeout_ms ? timeout_ms : REQ_TIMEOUT_MS_DEFAULT;
+	uint64_t deadline = os_time_ms() + actual_timeout;
+	os_wtimer_start(s_timers, &w->timer, deadline);
+
+	// A send failure loses to a deadline that already resolved the request:
+	// its outcome (the timeout) is on its way, so the call counts as sent
+	if (rpc_trans_send_msg(MSG_REQ, seq, name, rpc_trans_method_id(name), rpc_trans_budget(deadline),
+	                       (const uint8_t*)args, args_len) != RPC_SUCCESS &&
+	    rpc_trans_claim_waiter(w, seq)) {
+		RPC_LOG_ERROR("Failed to send message to link layer: %s, args_len: %u", name, args_len);
+		rpc_trans_free_waiter(w);
+		return RPC_ERROR;
+	}
+
+	RPC_LOG_DEBUG("Async request sent: %s, sequence: %u", name, seq);
+	*out_w = w;
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief Send an RPC request whose outcome is passed to a callback.
+ *
+ * The callback is run by the executor, or by rpc_trans_poll() without one.
+ *
+ * @param name Function name to call.
+ * @param args Arguments buffer.
+ * @param args_len Arguments length.
+ * @param timeout_ms Timeout in milliseconds.
+ * @param done Completion callback.
+ * @param user Argument of @p done.
+ * @return RPC_SUCCESS if the request was sent, error code otherwise
+ *         (@p done is then never called).
+ */
+int rpc_trans_request_async(const char* name,
+                            const void* args, uint16_t args_len,
+                            uint32_t timeout_ms,
+                            rpc_done_fn done, void* user)
+{
+	waiter_t* w;
+
+	if (!done) {
+		RPC_LOG_ERROR("RPC async call failed: callback is NULL");
+		return RPC_ERROR;
+	}
+	return rpc_trans_send_async(name, args, args_len, timeout_ms, WAIT_CALLBACK, done, user, &w);
+}
+
+
+/**
+ * @brief Send an RPC request whose outcome is kept in a future.
+ *
+ * @param name Function name to call.
+ * @param args Arguments buffer.
+ * @param args_len Arguments length.
+ * @param timeout_ms Timeout in milliseconds.
+ * @param out Future of the request.
+ * @return RPC_SUCCESS if the request was sent, error code otherwise.
+ */
+int rpc_trans_request_future(const char* name,
+                             const void* args, uint16_t args_len,
+                             uint32_t timeout_ms, rpc_future_t* out)
+{
+	waiter_t* w;
+
+	if (!out) return RPC_ERROR_INVALID_ARGS;
+	int rc = rpc_trans_send_async(name, args, args_len, timeout_ms, WAIT_FUTURE, NULL, NULL, &w);
+	*out = (rc == RPC_SUCCESS) ? (rpc_future_t)(void*)w : NULL;
+	return rc;
+}
+
+
+/**
+ * @brief Whether the request of a future has its outcome.
+ */
+static bool rpc_trans_future_resolved(rpc_future_t f)
+{
+	return atomic_load(&((waiter_t*)(void*)f)->fstate) & FUT_RESOLVED;
+}
+
+
+/**
+ * @brief Wait for the outcome of a future until @p end_ms.
+ *
+ * Wakeups are only hints (one may be left over from a wait-any group), so
+ * the state is checked after each.
+ */
+static int rpc_trans_future_wait_until(rpc_future_t f, uint64_t end_ms)
+{
+	waiter_t* w = (waiter_t*)(void*)f;
+
+	while (!rpc_trans_future_resolved(f)) {
+		uint32_t left = rpc_trans_left_ms(end_ms);
+		if (left == 0) return RPC_ERROR_TIMEOUT;
+		os_sem_take(w->done, left);
+	}
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief Wait until the request of a future has its outcome.
+ *
+ * @param f Future.
+ * @param timeout_ms Longest wait, OS_WAIT_FOREVER to wait for the outcome
+ *        (bounded by the request's own timeout).
+ * @return RPC_SUCCESS once resolved, RPC_ERROR_TIMEOUT if still pending.
+ */
+int rpc_trans_future_wait(rpc_future_t f, uint32_t timeout_ms)
+{
+	if (!f) return RPC_ERROR_INVALID_ARGS;
+	return rpc_trans_future_wait_until(f, rpc_trans_end_ms(timeout_ms));
+}
+
+
+/**
+ * @brief Give up a future; its request is freed once resolved.
+ *
+ * @param f Future, invalid afterwards.
+ */
+void rpc_trans_future_release(rpc_future_t f)
+{
+	waiter_t* w = (waiter_t*)(void*)f;
+
+	if (!w) return;
+	if (atomic_fetch_or(&w->fstate, FUT_RELEASED) & FUT_SIGNALLED) rpc_trans_future_free(w);
+}
+
+
+/**
+ * @brief Wait for the outcome of a future, take its response and release it.
+ *
+ * @param f Future, invalid afterwards.
+ * @param resp_buf Response buffer.
+ * @param resp_len Response length (input: capacity, output: actual length).
+ * @return Result of the request, RPC_ERROR_OVERFLOW if the response does
+ *         not fit @p resp_buf.
+ */
+int rpc_trans_future_get(rpc_future_t f, void* resp_buf, uint16_t* resp_len)
+{
+	waiter_t* w = (waiter_t*)(void*)f;
+
+	if (!w) return RPC_ERROR_INVALID_ARGS;
+
+	// Every request is resolved by its deadline at the latest
+	rpc_trans_future_wait_until(f, UINT64_MAX);
+
+	int rc = w->result_code;
+	if (RPC_IS_SUCCESS(rc) && resp_len) {
+		if (*resp_len < w->async_len || (w->async_len && !resp_buf)) {
+			rc = RPC_ERROR_OVERFLOW;
+			*resp_len = 0;
+		} else {
+			memcpy(resp_buf, w->async_resp, w->async_len);
+			*resp_len = w->async_len;
+		}
+	} else if (resp_len) {
+		*resp_len = 0;
+	}
+
+	rpc_trans_future_release(f);
+	return rc;
+}
+
+
+/**
+ * @brief Index of the first resolved future, -1 if none.
+ */
+static int rpc_trans_first_resolved(const rpc_future_t* fs, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		if (rpc_trans_future_resolved(fs[i])) return (int)i;
+	return -1;
+}
+
+
+/**
+ * @brief Wait until any of several futures has its outcome.
+ *
+ * The semaphore of the first future serves the whole group: every future
+ * is pointed at it while the caller sleeps. Before returning, the futures
+ * are pointed back at their own semaphores and wakeups already on their
+ * way to the group are waited out, so none reaches it once this returns.
+ *
+ * @param fs Futures.
+ * @param n Number of futures.
+ * @param timeout_ms Longest wait.
+ * @return Index of a resolved future, RPC_ERROR_TIMEOUT if none resolved.
+ */
+int rpc_trans_wait_any(const rpc_future_t* fs, size_t n, uint32_t timeout_ms)
+{
+	if (!fs || n == 0 || n > INT32_MAX) return RPC_ERROR_INVALID_ARGS;
+	for (size_t i = 0; i < n; i++)
+		if (!fs[i]) return RPC_ERROR_INVALID_ARGS;
+
+	int idx = rpc_trans_first_resolved(fs, n);
+	if (idx >= 0) return idx;
+	if (timeout_ms == OS_NO_WAIT) return RPC_ERROR_TIMEOUT;
+
+	uint64_t end_ms = rpc_trans_end_ms(timeout_ms);
+	os_sem_t group = ((waiter_t*)(void*)fs[0])->done;
+
+	for (size_t i = 0; i < n; i++) atomic_store(&((waiter_t*)(void*)fs[i])->wake, group);
+
+	for (;;) {
+		idx = rpc_trans_first_resolved(fs, n);
+		if (idx >= 0) break;
+		uint32_t left = rpc_trans_left_ms(end_ms);
+		if (left == 0) break;
+		os_sem_take(group, left);
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		waiter_t* w = (waiter_t*)(void*)fs[i];
+		atomic_store(&w->wake, w->done);
+	}
+	// A resolver between its FUT_RESOLVED and FUT_SIGNALLED is about to give
+	// (or has given) the group: catch that give spinning, or sleep for it.
+	// One that read its own semaphore instead is rechecked every tick
+	for (size_t i = 0; i < n; i++) {
+		waiter_t* w = (waiter_t*)(void*)fs[i];
+		uint32_t st;
+		while (((st = atomic_load(&w->fstate)) & FUT_RESOLVED) && !(st & FUT_SIGNALLED))
+			os_sem_take_spin(group, s_spin_max_ns, RPC_TIMER_TICK_MS);
 	}
 
-	return RPC_ERROR;
+	return (idx >= 0) ? idx : RPC_ERROR_TIMEOUT;
 }
 
 
 /**
- * @brief Find waiter by sequence number.
+ * @brief Wait until all of several futures have their outcome.
  *
- * @param seq Sequence number.
- * @return Pointer to waiter or NULL if not found.
+ * @param fs Futures.
+ * @param n Number of futures.
+ * @param timeout_ms Longest wait for all of them.
+ * @return RPC_SUCCESS once all resolved, RPC_ERROR_TIMEOUT otherwise.
  */
-static waiter_t* rpc_trans_find_waiter(uint8_t seq)
+int rpc_trans_wait_all(const rpc_future_t* fs, size_t n, uint32_t timeout_ms)
 {
-	waiter_t *ret = NULL;
+	if (!fs && n) return RPC_ERROR_INVALID_ARGS;
 
-	os_mutex_lock(s_wait_mtx);
-	for (int i = 0; i < REQ_TABLE_SIZE; i++) {
-		if (s_wait[i].in_use && s_wait[i].seq == seq) ret = &s_wait[i];
+	uint64_t end_ms = rpc_trans_end_ms(timeout_ms);
+	for (size_t i = 0; i < n; i++) {
+		if (!fs[i]) return RPC_ERROR_INVALID_ARGS;
+		int rc = rpc_trans_future_wait_until(fs[i], end_ms);
+		if (rc != RPC_SUCCESS) return rc;
 	}
-	os_mutex_unlock(s_wait_mtx);
-
-	return ret;
+	return RPC_SUCCESS;
 }
 
 
 /**
- * @brief Free waiter after completion.
- *
- * @param w Waiter pointer.
+ * @brief Descriptor that is readable while rpc_trans_poll() has work.
  */
-static void rpc_trans_free_waiter(waiter_t* w)
+int rpc_trans_poll_fd(void)
 {
-	if (!w) return;
-
-	os_mutex_lock(s_wait_mtx);
-	w->in_use = false;
-	os_mutex_unlock(s_wait_mtx);
+	return os_event_fd(s_poll_ev);
 }
 
 
-
 /**
- * @brief Initialize the RPC transport layer.
+ * @brief Run queued completion callbacks and stream handlers in the caller's thread.
  *
- * Creates mutexes, initializes waiter table, and creates inter-layer queues.
+ * Takes at most one batch from each queue so a busy peer cannot keep the
+ * caller's event loop here; whatever is left keeps the descriptor readable.
+ *
+ * @return Number of callbacks and handlers run.
  */
-void rpc_trans_init(void)
+int rpc_trans_poll(void)
 {
-	s_worker_count = os_mutex_create();
-	s_reg_mtx = os_mutex_create();
-	rpc_trans_init_waiter();
-	qLinkToTrans = os_queue_create(Q_LINK_TO_TRANS_DEPTH, sizeof(link_payload_t));
-	qTransToLink = os_queue_create(Q_TRANS_TO_LINK_DEPTH, sizeof(link_payload_t));
-	qRpcRequests = os_queue_create(Q_RPC_REQUEST_DEPTH, sizeof(rpc_request_t));
+	waiter_t* done[Q_DRAIN_BATCH];
+
+	// Reset before draining: anything queued from here on signals again
+	atomic_store(&s_poll_signalled, false);
+	os_event_clear(s_poll_ev);
+
+	size_t nd = os_queue_recv_n(qPollDone, done, Q_DRAIN_BATCH, OS_NO_WAIT);
+	for (size_t i = 0; i < nd; i++) rpc_trans_run_done(done[i]);
+
+	// Streams are handled in place in their queue slot
+	size_t ns = 0;
+	const rpc_request_t* req;
+	while (ns < Q_DRAIN_BATCH && (req = os_queue_peek(qPollStreams, OS_NO_WAIT)) != NULL) {
+		rpc_worker_handle(0, req);
+		os_queue_release(qPollStreams, req);
+		ns++;
+	}
+
+	if (nd == Q_DRAIN_BATCH || ns == Q_DRAIN_BATCH) rpc_trans_poll_notify();
 
+	return (int)(nd + ns);
 }
 
 
 /**
- * @brief Send an RPC request and wait for response.
+ * @brief Send an RPC stream message (no response expected).
  *
  * @param name Function name to call.
  * @param args Arguments buffer.
  * @param args_len Arguments length.
- * @param resp_buf Response buffer.
- * @param resp_len Response length (input: capacity, output: actual length).
- * @param timeout_ms Timeout in milliseconds.
  * @return RPC_SUCCESS on success, error code on failure.
  */
-int rpc_trans_request(const char* name,
-			 const void* args, uint16_t args_len,
-			 void* resp_buf, uint16_t* resp_len,
-			 uint32_t timeout_ms)
+int rpc_trans_stream(const char* name, const void* args, uint16_t args_len)
 {
-    RPC_LOG_TRACE("RPC call started: %s, args_len: %u, timeout: %u ms",
-                  name ? name : "(null)", args_len, timeout_ms);
+    RPC_LOG_TRACE("RPC stream started: %s, args_len: %u",
+                  name ? name : "(null)", args_len);
 
-    // Function name validation
+    // Check function name
     if (!name) {
-        RPC_LOG_ERROR("RPC call failed: name is NULL");
+        RPC_LOG_ERROR("RPC stream failed: name is NULL");
         return RPC_ERROR;
     }
 
@@ -373,154 +2195,154 @@ int rpc_trans_request(const char* name,
         return RPC_ERROR;
     }
 
-    // Validate the response buffer
-    if (!resp_buf || !resp_len) {
-        RPC_LOG_ERROR("Invalid response buffer (NULL pointer), function: %s", name);
+    // Generate message (without waiter) and send to link layer
+    if (rpc_trans_send_msg(MSG_STREAM, 0, name, rpc_trans_method_id(name), 0,
+                           (const uint8_t*)args, args_len) != RPC_SUCCESS) {
+        RPC_LOG_ERROR("Failed to send STREAM message: %s, args_len: %u", name, args_len);
         return RPC_ERROR;
     }
 
-    if (*resp_len < MAX_FUNC_ARGS_RESP_SIZE) {
-        RPC_LOG_ERROR("Response buffer too small (%u < %u), function: %s",
-                      *resp_len, MAX_FUNC_ARGS_RESP_SIZE, name);
-        return RPC_ERROR;
-    }
+    RPC_LOG_TRACE("STREAM message sent: %s", name);
+    return RPC_SUCCESS;
+}
 
-    // Allocate a waiter
-	uint8_t seq = 0;
-	waiter_t* w = NULL;
-	if (rpc_trans_alloc_waiter(&seq, &w) != 0) {
-		RPC_LOG_ERROR("No free waiters available for RPC call: %s", name);
-		return RPC_ERROR;
-	}
-	RPC_LOG_DEBUG("Allocated waiter, sequence: %u", seq);
 
-	// Initialize the waiter
-	w->resp_buf = (uint8_t*)resp_buf;
-	w->resp_len = resp_len;
-	w->resp_buf_cap = *resp_len;
 
-	// Forming a message
-	link_payload_t lp;
-	lp.payload_len = rpc_trans_build_msg(MSG_REQ, seq, name,
-			                             (const uint8_t*)args, args_len,
-										 lp.payload, sizeof(lp.payload));
-	if (!lp.payload_len) {
-		RPC_LOG_ERROR("Failed to build message for RPC: %s, args_len: %u", name, args_len);
-		rpc_trans_free_waiter(w);
-		return RPC_ERROR;
-	}
-	RPC_LOG_DEBUG("Message built successfully, size: %zu bytes", lp.payload_len);
+/**
+ * @brief Write a request descriptor straight into a queue slot, without waiting.
+ *
+ * @return true if queued, false if the queue is full.
+ */
+static bool rpc_trans_queue_put(os_queue_t q, const rpc_request_t* desc)
+{
+	rpc_request_t* req = os_queue_reserve(q, OS_NO_WAIT);
+	if (!req) return false;
+	*req = *desc;
+	os_queue_commit(q, req);
+	return true;
+}
 
-	// Send to link-layer queue
-	if (os_queue_send(qTransToLink, &lp, OS_WAIT_FOREVER) != OS_TRUE) {
-		RPC_LOG_ERROR("Failed to send message to qTransToLink: %s", name);
-		rpc_trans_free_waiter(w);
-		return RPC_ERROR;
-	}
-	RPC_LOG_TRACE("Message sent to link layer");
 
-	// Waiting for response
-	uint32_t actual_timeout = timeout_ms ? timeout_ms : REQ_TIMEOUT_MS_DEFAULT;
-	RPC_LOG_DEBUG("Waiting for response, timeout: %u ms", actual_timeout);
-	if (os_sem_take(w->done, actual_timeout) != OS_TRUE) {
-		RPC_LOG_ERROR("RPC call timeout: %s, sequence: %u, timeout: %u ms",
-				      name, seq, actual_timeout);
-		rpc_trans_free_waiter(w);
-		return RPC_ERROR;
+/**
+ * @brief First idle worker of a work-stealing class from position @p start.
+ *
+ * @return Worker, NULL if all are busy.
+ */
+static worker_t* rpc_trans_idle_worker(dclass_t* k, size_t start)
+{
+	for (uint8_t i = 0; i < k->cfg.workers; i++) {
+		worker_t* w = &k->w[(start + i) % k->cfg.workers];
+		if (atomic_load_explicit(&w->idle, memory_order_relaxed)) return w;
 	}
-
-	// Read the result
-	int rc = w->result_code;
-
-	// Logging depending on the result
-    if (RPC_IS_SUCCESS(rc)) {
-        RPC_LOG_INFO("RPC call succeeded: %s, response length: %u\n",
-                    name, (resp_len && *resp_len) ? *resp_len : 0);
-    } else {
-        RPC_LOG_ERROR("RPC call failed: %s, error code: %d, response length: %u\n",
-                    name, rc, (resp_len && *resp_len) ? *resp_len : 0);
-    }
-
-	rpc_trans_free_waiter(w);
-	return rc;
+	return NULL;
 }
 
 
 /**
- * @brief Send an RPC stream message (no response expected).
+ * @brief Queue a request to an elastic class, starting a worker if a
+ *        backlog builds up while none is idle.
  *
- * @param name Function name to call.
- * @param args Arguments buffer.
- * @param args_len Arguments length.
- * @return RPC_SUCCESS on success, error code on failure.
+ * @return true if queued, false if the class queue is full.
  */
-int rpc_trans_stream(const char* name, const void* args, uint16_t args_len)
+static bool rpc_trans_dispatch_elastic(dclass_t* k, const rpc_request_t* desc)
 {
-    RPC_LOG_TRACE("RPC stream started: %s, args_len: %u",
-                  name ? name : "(null)", args_len);
+	// Counted first: a worker may take the request before the reserve returns
+	size_t queued = atomic_fetch_add_explicit(&k->queued, 1, memory_order_relaxed) + 1;
+
+	rpc_request_t* req = os_queue_reserve(k->q, OS_NO_WAIT);
+	if (!req) {
+		atomic_fetch_sub_explicit(&k->queued, 1, memory_order_relaxed);
+		rpc_worker_grow(k);
+		return false;
+	}
+	*req = *desc;
+	req->queued_ns = os_time_ns();
+	os_queue_commit(k->q, req);
 
-    // Check function name
-    if (!name) {
-        RPC_LOG_ERROR("RPC stream failed: name is NULL");
-        return RPC_ERROR;
-    }
+	if (queued >= RPC_POOL_GROW_DEPTH) rpc_worker_grow(k);
+	return true;
+}
 
-    size_t nlen = strlen(name);
-    if (nlen < MIN_FUNC_NAME_LEN || nlen > MAX_FUNC_NAME_LEN) {
-        RPC_LOG_ERROR("Invalid RPC function name length: %zu", nlen);
-        return RPC_ERROR;
-    }
 
-    // Generate message (without waiter)
-    link_payload_t lp;
-    lp.payload_len = rpc_trans_build_msg(MSG_STREAM, 0, name,
-                                         (const uint8_t*)args, args_len,
-                                         lp.payload, sizeof(lp.payload));
-    if (!lp.payload_len) {
-        RPC_LOG_ERROR("Failed to build STREAM message: %s, args_len: %u", name, args_len);
-        return RPC_ERROR;
-    }
-    RPC_LOG_DEBUG("STREAM message built successfully, size: %zu bytes", lp.payload_len);
+/**
+ * @brief Queue a request to the workers of its dispatch class.
+ *
+ * With work stealing the request goes to the deque of an idle worker if
+ * there is one, otherwise round robin (to the next deque with room). A
+ * worker announces that it is idle before its last look for work, and the
+ * transport thread checks the announcements after queuing (seq_cst fences
+ * on both sides), so a worker falling asleep meanwhile is either seen here
+ * and handed a request, or finds the request itself.
+ *
+ * @param k Dispatch class.
+ * @param desc Request descriptor.
+ * @return true if queued, false if the class's queues are full.
+ */
+static bool rpc_trans_dispatch(dclass_t* k, const rpc_request_t* desc)
+{
+	if (k->elastic) return rpc_trans_dispatch_elastic(k, desc);
+	if (!k->steal) return rpc_trans_queue_put(k->q, desc);
+
+	uint8_t n = k->cfg.workers;
+	size_t start = k->next++ % n; // Transport thread only
+	worker_t* t = rpc_trans_idle_worker(k, start);
+	if (t) {
+		// Claimed: the next request goes elsewhere until it has looked again
+		atomic_store_explicit(&t->idle, false, memory_order_relaxed);
+		if (rpc_trans_queue_put(t->q, desc)) return true;
+	}
 
-    // Send to lower level queue
-    if (os_queue_send(qTransToLink, &lp, OS_WAIT_FOREVER) != OS_TRUE) {
-        RPC_LOG_ERROR("Failed to send STREAM message to qTransToLink: %s", name);
-        return RPC_ERROR;
-    }
+	t = &k->w[start];
+	for (uint8_t i = 1; !rpc_trans_queue_put(t->q, desc); i++) {
+		if (i == n) return false;
+		t = &k->w[(start + i) % n];
+	}
 
-    RPC_LOG_TRACE("STREAM message sent: %s", name);
-    return RPC_SUCCESS;
+	atomic_thread_fence(memory_order_seq_cst);
+	worker_t* w = rpc_trans_idle_worker(k, start);
+	rpc_request_t moved;
+	if (w && w != t && os_queue_recv_n(t->q, &moved, 1, OS_NO_WAIT) == 1) {
+		atomic_store_explicit(&w->idle, false, memory_order_relaxed);
+		if (!rpc_trans_queue_put(w->q, &moved)) rpc_trans_queue_put(t->q, &moved);
+	}
+	return true;
 }
 
 
 /**
- * @brief Handle incoming messages from link layer.
+ * @brief Handle an incoming payload.
  *
  * This function resolves waiters (for RESP/ERR) or
- * enqueues requests to worker threads (for REQ/STREAM).
+ * enqueues requests to worker threads (for REQ/STREAM);
+ * the reactor runtime runs the handler in place instead.
+ * Responses are consumed where they lie; a request or stream not yet in
+ * an RX pool buffer is copied into one, since it outlives the payload.
  *
- * @param p Pointer to payload.
- * @param n Payload size.
+ * @param p Payload.
+ * @param n Payload length.
+ * @param b RX buffer holding the payload, NULL if none; ownership is taken.
  */
-static void rpc_trans_handle_incoming(const uint8_t* p, size_t n)
+static void rpc_trans_handle_payload(const uint8_t* p, size_t n, rpc_buf_t* b)
 {
 	RPC_LOG_TRACE("Handling incoming message, size: %zu bytes", n);
 
-	uint8_t type = 0, seq = 0;
+	uint8_t type = 0;
+	uint32_t seq = 0;
 	const char* name = NULL;
 	const uint8_t* args = NULL;
-	uint16_t alen = 0;
+	uint16_t alen = 0, id = 0, budget = 0;
 
 	// Parsing the message
-	if (rpc_trans_parse_msg(p, n, &type, &seq, &name, &args, &alen) != 0) {
+	if (rpc_trans_parse_msg(p, n, &type, &seq, &name, &id, &budget, &args, &alen) != 0) {
 		RPC_LOG_ERROR("Failed to parse message, size: %lu bytes", n);
+		rpc_buf_release(b);
 		return; // Incorrect format - ignore
 	}
-	RPC_LOG_INFO("Parsed message: type=%s, seq=%u, name=%s, args_len=%u",
+	RPC_LOG_INFO("Parsed message: type=%s, seq=%u, name=%s, id=%u, args_len=%u",
 	              (type == MSG_REQ) ? "REQUEST" :
 	              (type == MSG_STREAM) ? "STREAM" :
 	              (type == MSG_RESP) ? "RESPONSE" : "ERROR",
-				  seq, name ? name : "NULL", alen);
+				  seq, name ? name : "NULL", id, alen);
 
 	// === Handling RESPONSE / ERROR messages ===
 	if (type == MSG_RESP || type == MSG_ERR) {
@@ -529,6 +2351,8 @@ static void rpc_trans_handle_incoming(const uint8_t* p, size_t n)
 	    if (w) {
 	        int rc = (type == MSG_RESP) ? RPC_SUCCESS : RPC_ERROR;
 
+	        rpc_trans_rtt_add(w->rtt_tag, os_time_ns() - w->sent_ns);
+
 	        if (alen > w->resp_buf_cap) {
 	        	// Buffer is smaller than required - error
 	            RPC_LOG_ERROR("Response buffer overflow: need=%u, cap=%u, seq=%u",
@@ -537,7 +2361,8 @@ static void rpc_trans_handle_incoming(const uint8_t* p, size_t n)
 	            if (w->resp_len) {
 	                *w->resp_len = 0; // nothing copied
 	            }
-	            os_sem_give(w->done);
+	            rpc_trans_resolve(w);
+	            rpc_buf_release(b);
 	            return; // exit
 	        }
 
@@ -550,25 +2375,291 @@ static void rpc_trans_handle_incoming(const uint8_t* p, size_t n)
 	        }
 	        w->result_code = rc;
 
-	        os_sem_give(w->done);
+	        rpc_trans_resolve(w);
 	        RPC_LOG_INFO("Waiter awakened for seq: %u", seq);
+	    } else if (rpc_trans_is_late_response(seq)) {
+	        RPC_LOG_DEBUG("Dropped late response for timed-out request, seq: %u", seq);
 	    } else {
 	        RPC_LOG_ERROR("No waiter found for response, seq: %u", seq);
 	    }
+	    rpc_buf_release(b);
 	    return;
 	}
 
 	// === Processing REQUEST / STREAM messages ===
-	if (type == MSG_REQ || type == MSG_STREAM) {
-		rpc_request_t req = {0};
-		req.type = type;
-		req.seq  = seq;
-		strncpy(req.name, name, MAX_FUNC_NAME_LEN);
-		memcpy(req.args, args, alen);
-		req.alen = alen;
-
-		if (os_queue_send(qRpcRequests, &req, 0) != OS_TRUE) {
-			RPC_LOG_ERROR("qRpcRequests full, drop request: %s", req.name);
+	if (!b) {
+		// This thread also resolves responses: with every buffer queued or
+		// held by handlers the request is dropped, as with a full queue
+		b = rpc_buf_alloc(RPC_BUF_POOL_RX, n, OS_NO_WAIT);
+		if (!b) {
+			RPC_LOG_ERROR("No RX buffer, drop %s: %s",
+			              (type == MSG_STREAM) ? "stream" : "request", name);
+			return;
+		}
+		memcpy(b->data, p, n);
+		b->len = (uint16_t)n;
+		if (!id) name = (const char*)b->data + (name - (const char*)p);
+		args = b->data + (args - p);
+	}
+
+	uint8_t cls;
+	rpc_fn_t fn = rpc_trans_lookup(name, id, &cls);
+
+	// The buffer moves on to the worker, the descriptor points into it;
+	// the budget runs from here (time in transit is not known)
+	const rpc_request_t desc = {
+		.buf  = b,
+		.fn   = fn,
+		.deadline_ms = (budget && type == MSG_REQ) ? os_time_ms() + budget : 0,
+		.cls  = cls,
+		.name = name,
+		.args = args,
+		.alen = alen,
+		.id   = id,
+		.type = type,
+		.seq  = seq,
+	};
+
+	if (s_runtime == RPC_RUNTIME_REACTOR && !(type == MSG_STREAM && s_poll_streams)) {
+		rpc_worker_handle(0, &desc); // Handlers must not block the event loop
+		return;
+	}
+
+	bool polled = (type == MSG_STREAM && s_poll_streams);
+	bool queued = polled ? rpc_trans_queue_put(qPollStreams, &desc)
+	                     : rpc_trans_dispatch(&s_class[cls], &desc);
+	if (!queued) {
+		RPC_LOG_ERROR("%s full, drop %s: %s", polled ? "qPollStreams" : s_class[cls].qname,
+		              (type == MSG_STREAM) ? "stream" : "request", name);
+		rpc_buf_release(b);
+		return;
+	}
+
+	if (polled) rpc_trans_poll_notify();
+}
+
+
+/**
+ * @brief Handle incoming messages from link layer.
+ *
+ * Takes ownership of the buffer reference.
+ *
+ * @param b RX buffer holding the payload.
+ */
+void rpc_trans_handle_incoming(rpc_buf_t* b)
+{
+	rpc_trans_handle_payload(b->data, b->len, b);
+}
+
+
+/**
+ * @brief Handler deadline timer callback: answer the caller with a timeout error.
+ *
+ * The handler keeps running; its late result is dropped by the worker.
+ * Runs in the timer thread, which must not wait for TX ring space: with
+ * the ring full the error is dropped and the caller times out by itself.
+ *
+ * @param arg Request descriptor of the overdue handler.
+ */
+static void rpc_worker_on_deadline(void* arg)
+{
+    const rpc_request_t* req = arg;
+    static const char emsg[] = "TIMEOUT";
+
+    RPC_LOG_ERROR("Handler deadline expired: %s, seq=%u", req->name, req->seq);
+    if (rpc_trans_post_msg(MSG_ERR, req->seq, req->name, req->id, 0,
+                           (const uint8_t*)emsg, sizeof(emsg) - 1, OS_NO_WAIT) != RPC_SUCCESS) {
+        RPC_LOG_ERROR("TX ring full, dropped timeout error: %s, seq=%u", req->name, req->seq);
+    }
+}
+
+
+/**
+ * @brief Process one RPC request in a worker thread.
+ *
+ * Calls the registered function and sends the response (or an error)
+ * back for requests; streams are only processed. In the threaded runtime
+ * a request handler that overruns HANDLER_TIMEOUT_MS_DEFAULT, or its
+ * caller's deadline if that comes first, is answered with a timeout error
+ * when the deadline passes, and its result is dropped.
+ * A request whose caller's deadline has already passed is dropped without
+ * calling the handler (the caller has timed out, nobody waits for the
+ * answer); otherwise the handler gets the caller's remaining time.
+ *
+ * @param worker_num Worker number (for logging).
+ * @param req Request descriptor; its RX buffer is released here.
+ */
+static void rpc_worker_handle(uint32_t worker_num, const rpc_request_t* req)
+{
+    (void)worker_num; // Only logged
+    RPC_LOG_INFO("[Worker %u] Handling request: %s, seq=%u",
+                 worker_num, req->name, req->seq);
+
+    rpc_fn_t fn = req->fn;
+    uint8_t out[MAX_FUNC_ARGS_RESP_SIZE];
+    uint16_t olen = 0;
+    int rc = RPC_ERROR;
+
+    // Shed a request that waited in the queue past its caller's deadline
+    uint32_t budget = HANDLER_TIMEOUT_MS_DEFAULT;
+    uint64_t now = os_time_ms();
+    if (req->deadline_ms) {
+        if (now >= req->deadline_ms) {
+            atomic_fetch_add_explicit(&s_class[req->cls].expired, 1, memory_order_relaxed);
+            RPC_LOG_DEBUG("[Worker %u] Shed expired request: %s, seq=%u",
+                          worker_num, req->name, req->seq);
+            rpc_buf_release(req->buf);
+            return;
+        }
+        if (req->deadline_ms - now < budget) budget = (uint32_t)(req->deadline_ms - now);
+    }
+
+    // The handler writes to the stack: a ring record reserved for the
+    // response would hold up every message queued behind it meanwhile
+
+    // Find and call a registered function
+    bool overdue = false;
+    if (fn) {
+    	RPC_LOG_TRACE("[Worker %u] Found handler for: %s", worker_num, req->name);
+
+    	// The reactor cannot answer while its own loop runs the handler
+    	os_wtimer_t deadline;
+    	bool timed = (req->type == MSG_REQ && s_runtime == RPC_RUNTIME_THREADED);
+    	if (timed) {
+    	    os_wtimer_init(&deadline, rpc_worker_on_deadline, (void*)req);
+    	    os_wtimer_start(s_timers, &deadline, now + budget); // The caller's deadline, if earlier
+    	}
+
+        rc = fn(req->args, req->alen,
+        		           out, sizeof(out), &olen,
+        		           budget);
+
+        overdue = timed && !os_wtimer_cancel(s_timers, &deadline);
+
+        // insurance in case of wrong handler
+        if (olen > sizeof(out)) {
+        	RPC_LOG_ERROR("[Worker %u] BUG: handler returned olen=%u > cap=%u, name=%s",
+        			      worker_num, olen, (unsigned)sizeof(out), req->name);
+            rc = RPC_ERROR_OVERFLOW;
+            olen = 0; // we do not return corrupted data
+        }
+    }
+
+    if (overdue) {
+    	// The caller already got a timeout error
+        RPC_LOG_ERROR("[Worker %u] Dropped late handler result: %s, seq=%u",
+                      worker_num, req->name, req->seq);
+    } else if (req->type == MSG_REQ) {
+    	// Generating and sending a response
+        int sent;
+        if (rc == RPC_SUCCESS) {
+            sent = rpc_trans_send_msg(MSG_RESP, req->seq, req->name, req->id, 0, out, olen);
+            RPC_LOG_INFO("[Worker %u] Sent response message, args: %u bytes", worker_num, olen);
+        } else {
+        	const char* emsg = (!fn) ? "NOFUNC" :
+							   (rc == RPC_ERROR_OVERFLOW) ? "OVERFLOW" :
+							   (rc == RPC_ERROR_INVALID_ARGS) ? "INVALID_ARGS" :
+							   (rc == RPC_ERROR_TIMEOUT) ? "TIMEOUT" : "FAIL";
+            sent = rpc_trans_send_msg(MSG_ERR, req->seq, req->name, req->id, 0,
+                                      (const uint8_t*)emsg, (uint16_t)strlen(emsg));
+            RPC_LOG_ERROR("[Worker %u] Sent error message: %s", worker_num, emsg);
+        }
+
+        if (sent != RPC_SUCCESS) {
+        	RPC_LOG_ERROR("[Worker %u] Failed to send response to link layer, seq: %u",
+        			      worker_num, req->seq);
+        }
+    } else {
+    	// === STREAM ===
+        RPC_LOG_INFO("[Worker %u] STREAM processed (no response), name=%s",
+                     worker_num, req->name);
+    }
+
+    rpc_buf_release(req->buf); // name/args are no longer referenced
+}
+
+
+/**
+ * @brief Steal requests from the deques of the other workers of a class.
+ *
+ * @param w Thief.
+ * @param req Output: stolen requests, up to half a batch.
+ * @return Number of requests stolen.
+ */
+static size_t rpc_worker_steal(worker_t* w, rpc_request_t* req)
+{
+	uint8_t n = w->k->cfg.workers;
+
+	for (uint8_t i = 1; i < n; i++) {
+		worker_t* v = &w->k->w[(w->index + i) % n];
+		size_t got = os_queue_recv_n(v->q, req, (RPC_WORKER_BATCH + 1) / 2, OS_NO_WAIT);
+		if (got) return got;
+	}
+	return 0;
+}
+
+
+/**
+ * @brief Next requests of a worker of a work-stealing class.
+ *
+ * Own deque first, then the others'; with nothing found the worker
+ * announces that it is idle, looks once more and sleeps on its deque.
+ *
+ * @param w Worker.
+ * @param req Output: requests, up to RPC_WORKER_BATCH.
+ * @return Number of requests.
+ */
+static size_t rpc_worker_next(worker_t* w, rpc_request_t* req)
+{
+	size_t n = os_queue_recv_n(w->q, req, RPC_WORKER_BATCH, OS_NO_WAIT);
+	if (!n) n = rpc_worker_steal(w, req);
+	if (n) return n;
+
+	atomic_store_explicit(&w->idle, true, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	n = os_queue_recv_n(w->q, req, RPC_WORKER_BATCH, OS_NO_WAIT);
+	if (!n) n = rpc_worker_steal(w, req);
+	if (!n) n = os_queue_recv_n(w->q, req, RPC_WORKER_BATCH, OS_WAIT_FOREVER);
+	atomic_store_explicit(&w->idle, false, memory_order_relaxed);
+	return n;
+}
+
+
+/**
+ * @brief Next requests of a worker of an elastic class.
+ *
+ * Waits up to RPC_POOL_LINGER_MS; a worker above the class minimum that
+ * got nothing in that time retires. A request that waited longer than
+ * RPC_POOL_GROW_RESIDENCE_US, or a backlog of RPC_POOL_GROW_DEPTH left
+ * behind, starts another worker if none is idle.
+ *
+ * @param k Dispatch class.
+ * @param req Output: requests, up to RPC_WORKER_BATCH.
+ * @return Number of requests, 0 if the worker is to exit.
+ */
+static size_t rpc_worker_next_elastic(dclass_t* k, rpc_request_t* req)
+{
+	for (;;) {
+		atomic_fetch_add_explicit(&k->idle, 1, memory_order_relaxed);
+		size_t n = os_queue_recv_n(k->q, req, RPC_WORKER_BATCH, RPC_POOL_LINGER_MS);
+		atomic_fetch_sub_explicit(&k->idle, 1, memory_order_relaxed);
+
+		if (n) {
+			size_t left = atomic_fetch_sub_explicit(&k->queued, n, memory_order_relaxed) - n;
+			if (left >= RPC_POOL_GROW_DEPTH ||
+			    os_time_ns() - req[0].queued_ns > RPC_POOL_GROW_RESIDENCE_US * 1000ULL)
+				rpc_worker_grow(k);
+			return n;
+		}
+
+		// Lingered idle: leave if the class keeps its minimum without us
+		uint8_t live = atomic_load_explicit(&k->live, memory_order_relaxed);
+		while (live > k->cfg.workers) {
+			if (atomic_compare_exchange_weak_explicit(&k->live, &live, live - 1,
+			                                          memory_order_relaxed, memory_order_relaxed)) {
+				atomic_fetch_add_explicit(&k->retired, 1, memory_order_relaxed);
+				return 0;
+			}
 		}
 	}
 }
@@ -577,105 +2668,186 @@ static void rpc_trans_handle_incoming(const uint8_t* p, size_t n)
 /**
  * @brief Worker thread function for processing requests.
  *
- * Processes RPC requests from the queue, calls registered functions,
- * and sends responses back.
+ * Takes RPC requests from the queue of its dispatch class in batches of
+ * up to RPC_WORKER_BATCH and processes each with rpc_worker_handle().
+ * With work stealing it takes them from its own deque, and when that is
+ * empty steals up to half a batch from the other workers' deques before
+ * going to sleep (see rpc_trans_dispatch()).
  *
- * @param arg Not used.
+ * @param arg Worker (worker_t*).
  * @return NULL
  */
 static void* ThreadRPCWorker(void* arg)
 {
-    rpc_request_t req;
+    worker_t* w = (worker_t*)arg;
+    rpc_request_t req[RPC_WORKER_BATCH];
 
     os_mutex_lock(s_worker_count);
-    uint8_t worker_num = ++worker_count; // assign worker number
+    uint32_t worker_num = ++worker_count; // assign worker number
     os_mutex_unlock(s_worker_count);
 
     RPC_LOG_INFO("[Worker %u] thread started", worker_num);
 
-    for (;;) {
-        if (os_queue_recv(qRpcRequests, &req, OS_WAIT_FOREVER) == OS_TRUE) {
-            RPC_LOG_INFO("[Worker %u] Handling request: %s, seq=%u",
-                         worker_num, req.name, req.seq);
-
-            int idx = find_reg(req.name);
-            uint8_t out[MAX_FUNC_ARGS_RESP_SIZE];
-            uint16_t olen = 0;
-            int rc = RPC_ERROR;
-
-            // Find and call a registered function
-            if (idx >= 0 && s_reg[idx].fn) {
-            	RPC_LOG_TRACE("[Worker %u] Found handler for: %s", worker_num, name);
-                rc = s_reg[idx].fn(req.args, req.alen,
-                		           out, sizeof(out), &olen,
-                		           HANDLER_TIMEOUT_MS_DEFAULT);
-
-                // insurance in case of wrong handler
-                if (olen > sizeof(out)) {
-                	RPC_LOG_ERROR("[Worker %u] BUG: handler returned olen=%u > cap=%u, name=%s",
-                			      worker_num, olen, (unsigned)sizeof(out), req.name);
-                    rc = RPC_ERROR_OVERFLOW;
-                    olen = 0; // we do not return corrupted data
-                }
-            }
+    // Lets the next worker be started
+    atomic_store_explicit(&w->k->growing, false, memory_order_relaxed);
 
-            if (req.type == MSG_REQ) {
-            	// Generating a response
-                link_payload_t lp;
-                if (rc == RPC_SUCCESS) {
-                    lp.payload_len = rpc_trans_build_msg(MSG_RESP, req.seq, req.name, out, olen,
-                                                         lp.payload, sizeof(lp.payload));
-                    RPC_LOG_INFO("[Worker %u] Built response message, size: %zu bytes",
-                    		     worker_num, lp.payload_len);
-                } else {
-                	const char* emsg = (idx < 0) ? "NOFUNC" :
-									   (rc == RPC_ERROR_OVERFLOW) ? "OVERFLOW" :
-									   (rc == RPC_ERROR_INVALID_ARGS) ? "INVALID_ARGS" :
-									   (rc == RPC_ERROR_TIMEOUT) ? "TIMEOUT" : "FAIL";
-                    lp.payload_len = rpc_trans_build_msg(MSG_ERR, req.seq, req.name,
-                                                         (const uint8_t*)emsg, (uint16_t)strlen(emsg),
-                                                         lp.payload, sizeof(lp.payload));
-                    RPC_LOG_ERROR("[Worker %u] Built error message: %s", worker_num, emsg);
-                }
-
-                // Sending a response
-                if (lp.payload_len) {
-                	if (os_queue_send(qTransToLink, &lp, OS_WAIT_FOREVER) != OS_TRUE) {
-						RPC_LOG_ERROR("[Worker %u] Failed to send response to qTransToLink, seq: %u",
-								      worker_num, req.seq);
-					}
-                }
-            } else {
-            	// === STREAM ===
-                RPC_LOG_INFO("[Worker %u] STREAM processed (no response), name=%s",
-                             worker_num, req.name);
+    for (;;) {
+        size_t n;
+        if (w->k->elastic) {
+            n = rpc_worker_next_elastic(w->k, req);
+            if (!n) {
+                // Retired: the slot may be taken by the next worker started
+                atomic_store_explicit(&w->used, false, memory_order_release);
+                break;
             }
+        } else {
+            n = w->k->steal ? rpc_worker_next(w, req)
+                            : os_queue_recv_n(w->q, req, RPC_WORKER_BATCH, OS_WAIT_FOREVER);
+        }
+        for (size_t i = 0; i < n; i++) {
+            rpc_worker_handle(worker_num, &req[i]);
         }
     }
+
+    RPC_LOG_INFO("[Worker %u] retired", worker_num);
     return NULL;
 }
 
 
+/**
+ * @brief Start a worker thread of a dispatch class.
+ *
+ * Threads are named in start order, so a worker started in a slot that
+ * an earlier one retired from gets a name of its own.
+ *
+ * @param k Dispatch class.
+ * @param slot Worker slot, already marked used.
+ * @return true if the thread was started.
+ */
+static bool rpc_worker_spawn(dclass_t* k, uint8_t slot)
+{
+	const rpc_class_cfg_t* cfg = &k->cfg;
+	uint32_t num = atomic_fetch_add_explicit(&k->started, 1, memory_order_relaxed);
+	char name[16];
+
+	// The default class keeps its thread names
+	if (k == &s_class[0]) snprintf(name, sizeof(name), "RPC_Worker%u", (unsigned)num);
+	else snprintf(name, sizeof(name), "RPC_W%zu_%u", (size_t)(k - s_class), (unsigned)num);
+	const os_thread_attr_t attr = {
+		.name       = name,
+		.stack_size = 1024,
+		.policy     = cfg->policy,
+		.priority   = cfg->priority,
+		.cpu_mask   = cfg->cpu_mask,
+	};
+	os_thread_t t = os_thread_create_ex(&attr, ThreadRPCWorker, &k->w[slot]);
+	if (!t) return false;
+
+	// Workers of an elastic class end on their own
+	if (k->elastic) os_thread_detach(t);
+	return true;
+}
+
+
+/**
+ * @brief Start one more worker of an elastic class if it has none idle.
+ *
+ * One start at a time: the next may follow once the new worker runs.
+ * Called by the transport thread and by workers.
+ */
+static void rpc_worker_grow(dclass_t* k)
+{
+	if (atomic_load_explicit(&k->idle, memory_order_relaxed)) return;
+	if (atomic_exchange_explicit(&k->growing, true, memory_order_relaxed)) return;
+
+	uint8_t live = atomic_load_explicit(&k->live, memory_order_relaxed);
+	do {
+		if (live >= k->cfg.max_workers) {
+			atomic_store_explicit(&k->growing, false, memory_order_relaxed);
+			return;
+		}
+	} while (!atomic_compare_exchange_weak_explicit(&k->live, &live, live + 1,
+	                                                memory_order_relaxed, memory_order_relaxed));
+
+	// A free slot, unless a retiring worker has yet to leave its own:
+	// the next request that backs up tries again
+	uint8_t slot = 0;
+	for (; slot < k->cfg.max_workers; slot++) {
+		bool used = false;
+		if (atomic_compare_exchange_strong_explicit(&k->w[slot].used, &used, true,
+		                                            memory_order_acquire, memory_order_relaxed))
+			break;
+	}
+	if (slot == k->cfg.max_workers || !rpc_worker_spawn(k, slot)) {
+		if (slot < k->cfg.max_workers) {
+			RPC_LOG_ERROR("Failed to start worker %u of %s", slot, k->qname);
+			atomic_store_explicit(&k->w[slot].used, false, memory_order_relaxed);
+		}
+		atomic_fetch_sub_explicit(&k->live, 1, memory_order_relaxed);
+		atomic_store_explicit(&k->growing, false, memory_order_relaxed);
+		return;
+	}
+
+	atomic_fetch_add_explicit(&k->spawned, 1, memory_order_relaxed);
+	uint8_t hw = atomic_load_explicit(&k->high_water, memory_order_relaxed);
+	while (live + 1 > hw &&
+	       !atomic_compare_exchange_weak_explicit(&k->high_water, &hw, live + 1,
+	                                              memory_order_relaxed, memory_order_relaxed)) {}
+}
+
+
 /**
  * @brief Start RPC worker threads.
  *
- * Creates and starts multiple worker threads for parallel
- * request processing.
+ * Creates and starts the worker threads of every dispatch class, with
+ * the class's scheduling settings: the minimum of an elastic class, or
+ * its maximum if workers may not be started later.
  */
-void rpc_worker_start_thread(void)
+void rpc_worker_start_thread(bool elastic)
 {
-	for (int i = 0; i < RPC_WORKER_COUNT; i++) {
-		char name[16];
-		snprintf(name, sizeof(name), "RPC_Worker%d", i);
-		os_thread_create(name, ThreadRPCWorker, NULL, 1024, 2);
+	for (size_t c = 0; c < s_class_count; c++) {
+		dclass_t* k = &s_class[c];
+		k->elastic = k->elastic && elastic; // Before the first request (RX starts later)
+		uint8_t n = k->elastic ? k->cfg.workers : k->cfg.max_workers;
+
+		for (uint8_t i = 0; i < n; i++) {
+			atomic_store_explicit(&k->w[i].used, true, memory_order_relaxed);
+			if (!rpc_worker_spawn(k, i)) {
+				atomic_store_explicit(&k->w[i].used, false, memory_order_relaxed);
+				RPC_LOG_ERROR("Failed to start worker %u of %s", i, k->qname);
+				break;
+			}
+			atomic_fetch_add_explicit(&k->live, 1, memory_order_relaxed);
+		}
+		atomic_store_explicit(&k->high_water, atomic_load_explicit(&k->live, memory_order_relaxed),
+		                      memory_order_relaxed);
 	}
 }
 
 
+/**
+ * @brief Worker pool statistics of a dispatch class.
+ */
+int rpc_trans_pool_stats(uint8_t cls, rpc_pool_stats_t* out)
+{
+	if (cls >= s_class_count || !out) return RPC_ERROR;
+
+	dclass_t* k = &s_class[cls];
+	out->workers = atomic_load_explicit(&k->live, memory_order_relaxed);
+	out->min_workers = k->elastic ? k->cfg.workers : k->cfg.max_workers;
+	out->max_workers = k->cfg.max_workers;
+	out->high_water = atomic_load_explicit(&k->high_water, memory_order_relaxed);
+	out->spawned = atomic_load_explicit(&k->spawned, memory_order_relaxed);
+	out->retired = atomic_load_explicit(&k->retired, memory_order_relaxed);
+	out->expired = atomic_load_explicit(&k->expired, memory_order_relaxed);
+	return RPC_SUCCESS;
+}
+
+
 /**
  * @brief Transport layer thread function.
  *
- * Processes messages from link layer queue:
+ * Processes payloads from the link-to-transport ring in place, oldest first:
  * - If response/error: resolves waiting request (by sequence number)
  * - If request/stream: forwards to worker threads via queue
  *
@@ -685,28 +2857,64 @@ void rpc_worker_start_thread(void)
 static void* ThreadTrans(void* arg)
 {
 	(void)arg;
-	link_payload_t m;
+	size_t len;
 
 	RPC_LOG_INFO("Transport thread started");
 
 	for (;;) {
-		if (os_queue_recv(qLinkToTrans, &m, OS_WAIT_FOREVER) == OS_TRUE) {
-			RPC_LOG_DEBUG("Received message from link layer, size: %zu bytes", m.payload_len);
-			rpc_trans_handle_incoming(m.payload, m.payload_len);
-			RPC_LOG_TRACE("Message processing completed");
-		}
+		// Sleeps only while the ring is empty
+		const uint8_t* p = os_ring_peek(qLinkToTrans, &len, OS_WAIT_FOREVER);
+		if (!p) continue;
+
+		RPC_LOG_DEBUG("Received message from link layer, size: %zu bytes", len);
+		rpc_trans_handle_payload(p, len, NULL);
+		os_ring_release(qLinkToTrans, p);
+		RPC_LOG_TRACE("Message processing completed");
 	}
 	return NULL;
 }
 
 
+/**
+ * @brief Timer thread function: drives the request/handler deadline wheel.
+ *
+ * @param arg Thread argument (unused).
+ * @return NULL.
+ */
+static void* ThreadTimers(void* arg)
+{
+	(void)arg;
+
+	RPC_LOG_INFO("Timer thread started");
+	os_twheel_run(s_timers);
+	return NULL;
+}
+
+
 static os_thread_t sThreadTrans;
+static os_thread_t sThreadTimers;
 
 /**
- * @brief Start the transport layer thread.
+ * @brief Start the transport layer and timer threads.
  */
 void rpc_transport_start_thread(void)
 {
-	sThreadTrans = os_thread_create("trans", ThreadTrans, NULL, 1024, 2);
+	const os_thread_attr_t attr = {
+		.name       = "trans",
+		.stack_size = 1024,
+		.policy     = RPC_THREAD_TRANS_POLICY,
+		.priority   = RPC_THREAD_TRANS_PRIORITY,
+		.cpu_mask   = RPC_THREAD_TRANS_CPU_MASK,
+	};
+	sThreadTrans = os_thread_create_ex(&attr, ThreadTrans, NULL);
+
+	const os_thread_attr_t timer_attr = {
+		.name       = "timers",
+		.stack_size = 1024,
+		.policy     = RPC_THREAD_TIMER_POLICY,
+		.priority   = RPC_THREAD_TIMER_PRIORITY,
+		.cpu_mask   = RPC_THREAD_TIMER_CPU_MASK,
+	};
+	sThreadTimers = os_thread_create_ex(&timer_attr, ThreadTimers, NULL);
 }
 
@@ -0,0 +1,355 @@
+/**
+ * @file    bench_latency.c
+ * @brief   Request round-trip latency: threaded pipeline vs reactor runtime.
+ *
+ * @details For each runtime a server process (registering "ping") and a
+ * client process are forked and connected through a private pair of
+ * FIFOs. The client issues sequential requests and reports the mean,
+ * median, 99th percentile and maximum round-trip time.
+ *
+ * Heap allocations in the client process are counted while it sends the
+ * measured requests, a burst of streams and untimed rounds of futures,
+ * async calls and batches (glibc allocator interposed, aligned variants
+ * included); in arena mode any such allocation fails the benchmark.
+ *
+ * The client waits for responses with the given strategy (default: the
+ * rpc_config.h one): "park" sleeps at once, "adaptive" spins for about
+ * the learned round trip first.
+ *
+ * @usage   ./bench_latency [requests] [threaded|reactor|all] [arena|heap] [park|adaptive]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include "rpc.h"
+#include "rpc_config.h"
+
+/** Default number of measured requests per runtime */
+#define BENCH_REQUESTS_DEFAULT  10000
+
+/** Requests sent before measuring */
+#define BENCH_WARMUP            200
+
+/** Per-request timeout in milliseconds */
+#define BENCH_TIMEOUT_MS        1000
+
+/** FIFO pair used by the benchmark */
+#define BENCH_FIFO_A            "/tmp/bench_latency_a"
+#define BENCH_FIFO_B            "/tmp/bench_latency_b"
+
+/** Streams sent after the measured requests (counted for heap use, not timed) */
+#define BENCH_STREAMS           1000
+
+/** Rounds of futures, async calls and a batch after the streams (counted, not timed) */
+#define BENCH_PIPE_ROUNDS       50
+
+/** Calls in flight per round (futures, async calls, batch entries) */
+#define BENCH_PIPE_DEPTH        32
+
+extern const char* path_fifo_first;
+extern const char* path_fifo_second;
+
+/** Arena mode for both processes */
+static bool s_arena;
+
+/** Response wait strategy of the client */
+static rpc_wait_t s_wait = RPC_WAIT_DEFAULT;
+
+
+// === Heap allocation counting (glibc) ===
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* p, size_t size);
+extern void* __libc_memalign(size_t align, size_t size);
+extern void* __libc_valloc(size_t size);
+
+static atomic_ulong s_heap_allocs; /**< Allocations since process start */
+
+void* malloc(size_t size)
+{
+	atomic_fetch_add_explicit(&s_heap_allocs, 1, memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size)
+{
+	atomic_fetch_add_explicit(&s_heap_allocs, 1, memory_order_relaxed);
+	return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size)
+{
+	atomic_fetch_add_explicit(&s_heap_allocs, 1, memory_order_relaxed);
+	return __libc_realloc(p, size);
+}
+
+int posix_memalign(void** p, size_t align, size_t size)
+{
+	atomic_fetch_add_explicit(&s_heap_allocs, 1, memory_order_relaxed);
+	*p = __libc_memalign(align, size);
+	return *p ? 0 : ENOMEM;
+}
+
+void* aligned_alloc(size_t align, size_t size)
+{
+	atomic_fetch_add_explicit(&s_heap_allocs, 1, memory_order_relaxed);
+	return __libc_memalign(align, size);
+}
+
+void* memalign(size_t align, size_t size)
+{
+	atomic_fetch_add_explicit(&s_heap_allocs, 1, memory_order_relaxed);
+	return __libc_memalign(align, size);
+}
+
+void* valloc(size_t size)
+{
+	atomic_fetch_add_explicit(&s_heap_allocs, 1, memory_order_relaxed);
+	return __libc_valloc(size);
+}
+
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+/**
+ * @brief Ping handler: answers "pong".
+ */
+static int handler_fn_ping(const uint8_t* args, uint16_t alen,
+                           uint8_t* out, uint16_t out_capacity,
+                           uint16_t* out_len, uint32_t timeout_ms)
+{
+	(void)args; (void)alen; (void)timeout_ms;
+
+	if (out_capacity < 4) return RPC_ERROR_OVERFLOW;
+	memcpy(out, "pong", 4);
+	*out_len = 4;
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief qsort() comparator for latency samples.
+ */
+static int cmp_u64(const void* a, const void* b)
+{
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+
+/**
+ * @brief Async completion: count the call, and a failure.
+ */
+static void on_ping_done(int rc, const uint8_t* resp, uint16_t resp_len, void* user)
+{
+	size_t* done = user;
+	(void)resp;
+
+	done[0]++;
+	if (rc != RPC_SUCCESS || resp_len != 4) done[1]++;
+}
+
+
+/**
+ * @brief Futures, async calls and a batch of BENCH_PIPE_DEPTH calls each.
+ *
+ * @return Number of failed calls.
+ */
+static size_t run_pipelined(void)
+{
+	rpc_future_t fs[BENCH_PIPE_DEPTH];
+	rpc_batch_entry_t be[BENCH_PIPE_DEPTH];
+	uint8_t resp[BENCH_PIPE_DEPTH][MAX_FUNC_ARGS_RESP_SIZE];
+	size_t failed = 0;
+
+	// Futures, collected in order
+	for (size_t i = 0; i < BENCH_PIPE_DEPTH; i++)
+		if (rpc_request_future("ping", NULL, 0, BENCH_TIMEOUT_MS, &fs[i]) != RPC_SUCCESS) fs[i] = NULL;
+	for (size_t i = 0; i < BENCH_PIPE_DEPTH; i++) {
+		uint16_t rlen = sizeof(resp[i]);
+		if (!fs[i] || rpc_future_get(fs[i], resp[i], &rlen) != RPC_SUCCESS) failed++;
+	}
+
+	// Async calls, completed from rpc_poll()
+	size_t done[2] = { 0, 0 }, issued = 0;
+	for (size_t i = 0; i < BENCH_PIPE_DEPTH; i++) {
+		if (rpc_request_async("ping", NULL, 0, BENCH_TIMEOUT_MS, on_ping_done, done) == RPC_SUCCESS) issued++;
+		else failed++;
+	}
+	struct pollfd pfd = { .fd = rpc_poll_fd(), .events = POLLIN };
+	while (done[0] < issued) {
+		if (!rpc_poll()) poll(&pfd, 1, BENCH_TIMEOUT_MS);
+	}
+	failed += done[1];
+
+	// One batch
+	for (size_t i = 0; i < BENCH_PIPE_DEPTH; i++)
+		be[i] = (rpc_batch_entry_t){ .name = "ping", .resp_buf = resp[i], .resp_len = sizeof(resp[i]) };
+	rpc_request_batch(be, BENCH_PIPE_DEPTH, BENCH_TIMEOUT_MS);
+	for (size_t i = 0; i < BENCH_PIPE_DEPTH; i++)
+		if (be[i].rc != RPC_SUCCESS) failed++;
+
+	return failed;
+}
+
+
+/**
+ * @brief Server process: serve "ping" until killed.
+ */
+static void run_server(rpc_runtime_t runtime)
+{
+	const rpc_init_cfg_t cfg = {
+		.runtime = runtime,
+		.arena = s_arena,
+		.arena_flags = OS_ARENA_HUGEPAGES | OS_ARENA_MLOCK,
+	};
+
+	path_fifo_first = BENCH_FIFO_A;
+	path_fifo_second = BENCH_FIFO_B;
+	if (rpc_init_ex(&cfg) < 0 || rpc_register("ping", handler_fn_ping) < 0) exit(EXIT_FAILURE);
+	rpc_start();
+
+	for (;;) os_delay_ms(OS_WAIT_FOREVER);
+}
+
+
+/**
+ * @brief Client process: measure @p requests sequential round trips.
+ */
+static void run_client(rpc_runtime_t runtime, const char* label, size_t requests)
+{
+	const rpc_init_cfg_t cfg = {
+		.runtime = runtime,
+		.arena = s_arena,
+		.arena_flags = OS_ARENA_HUGEPAGES | OS_ARENA_MLOCK,
+		.wait = s_wait,
+	};
+	uint64_t* lat = malloc(requests * sizeof(*lat));
+	uint8_t resp[MAX_FUNC_ARGS_RESP_SIZE];
+	uint16_t rlen;
+
+	path_fifo_first = BENCH_FIFO_B;
+	path_fifo_second = BENCH_FIFO_A;
+	if (!lat || rpc_init_ex(&cfg) < 0) exit(EXIT_FAILURE);
+	rpc_start();
+
+	for (size_t i = 0; i < BENCH_WARMUP; i++) {
+		rlen = sizeof(resp);
+		if (rpc_request("ping", NULL, 0, resp, &rlen, BENCH_TIMEOUT_MS) != RPC_SUCCESS) {
+			printf("%-9s warm-up request %zu failed\n", label, i);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	uint64_t sum = 0;
+	unsigned long heap0 = atomic_load(&s_heap_allocs);
+	for (size_t i = 0; i < requests; i++) {
+		rlen = sizeof(resp);
+		uint64_t t0 = now_ns();
+		int rc = rpc_request("ping", NULL, 0, resp, &rlen, BENCH_TIMEOUT_MS);
+		lat[i] = now_ns() - t0;
+		if (rc != RPC_SUCCESS) {
+			printf("%-9s request %zu failed: %d\n", label, i, rc);
+			exit(EXIT_FAILURE);
+		}
+		sum += lat[i];
+	}
+	for (size_t i = 0; i < BENCH_STREAMS; i++) {
+		if (rpc_stream("ping", NULL, 0) != RPC_SUCCESS) {
+			printf("%-9s stream %zu failed\n", label, i);
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (size_t i = 0; i < BENCH_PIPE_ROUNDS; i++) {
+		size_t failed = run_pipelined();
+		if (failed) {
+			printf("%-9s pipelined round %zu: %zu calls failed\n", label, i, failed);
+			exit(EXIT_FAILURE);
+		}
+	}
+	unsigned long heap = atomic_load(&s_heap_allocs) - heap0;
+
+	qsort(lat, requests, sizeof(*lat), cmp_u64);
+	printf("%-9s %8zu  %8.1f  %8.1f  %8.1f  %8.1f  %6lu\n", label, requests,
+	       (double)sum / (double)requests / 1e3,
+	       (double)lat[requests / 2] / 1e3,
+	       (double)lat[requests * 99 / 100] / 1e3,
+	       (double)lat[requests - 1] / 1e3,
+	       heap);
+	fflush(stdout);
+
+	// Arena mode promises no allocation once started
+	exit((s_arena && heap) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+
+/**
+ * @brief Run one runtime: fork server and client, wait for the client.
+ */
+static int bench_runtime(rpc_runtime_t runtime, const char* label, size_t requests)
+{
+	unlink(BENCH_FIFO_A);
+	unlink(BENCH_FIFO_B);
+	fflush(stdout);
+
+	pid_t server = fork();
+	if (server == 0) run_server(runtime);
+
+	pid_t client = fork();
+	if (client == 0) run_client(runtime, label, requests);
+
+	int status = EXIT_FAILURE;
+	waitpid(client, &status, 0);
+	kill(server, SIGKILL);
+	waitpid(server, NULL, 0);
+
+	unlink(BENCH_FIFO_A);
+	unlink(BENCH_FIFO_B);
+	return (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) ? 0 : -1;
+}
+
+
+/**
+ * @brief Benchmark entry point.
+ */
+int main(int argc, char* argv[])
+{
+	size_t requests = (argc > 1) ? strtoull(argv[1], NULL, 10) : BENCH_REQUESTS_DEFAULT;
+	const char* only = (argc > 2 && strcmp(argv[2], "all") != 0) ? argv[2] : NULL;
+	int rc = 0;
+
+	if (requests == 0) requests = BENCH_REQUESTS_DEFAULT;
+	s_arena = (argc > 3 && strcmp(argv[3], "arena") == 0);
+	if (argc > 4) s_wait = (strcmp(argv[4], "park") == 0) ? RPC_WAIT_PARK : RPC_WAIT_ADAPTIVE;
+
+	printf("===== RPC round-trip latency, sequential \"ping\" requests (us)%s%s =====\n",
+	       s_arena ? ", arena mode" : "",
+	       (s_wait == RPC_WAIT_PARK) ? ", parked waits" :
+	       (s_wait == RPC_WAIT_ADAPTIVE) ? ", adaptive waits" : "");
+	printf("%-9s %8s  %8s  %8s  %8s  %8s  %6s\n", "runtime", "requests", "mean", "p50", "p99", "max", "heap");
+
+	if (!only || strcmp(only, "threaded") == 0)
+		rc |= bench_runtime(RPC_RUNTIME_THREADED, "threaded", requests);
+	if (!only || strcmp(only, "reactor") == 0)
+		rc |= bench_runtime(RPC_RUNTIME_REACTOR, "reactor", requests);
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
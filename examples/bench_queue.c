@@ -0,0 +1,241 @@
+/**
+ * @file    bench_queue.c
+ * @brief   OSAL queue microbenchmark.
+ *
+ * @details Measures throughput and per-item cost of the OSAL queue
+ * flavours using the item sizes that travel through the RPC pipeline:
+ *          - 1 producer / 1 consumer: locked vs SPSC vs MPMC
+ *          - N producers / N consumers (N = 1..16): locked vs MPMC
+ *          - 1 producer / 1 consumer moving batches with os_queue_send_n()
+ *            / os_queue_recv_n() instead of single items
+ *          - 1 producer / 1 consumer writing and reading items in place
+ *            (os_queue_reserve() / os_queue_commit(), os_queue_peek() /
+ *            os_queue_release()) instead of copying whole items, including
+ *            the byte ring (records of exactly the item size)
+ *
+ * @usage   ./bench_queue [items]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "rpc_osal.h"
+#include "rpc_link.h"
+
+/** Default number of items pushed through each queue */
+#define BENCH_ITEMS_DEFAULT   2000000
+
+/** Queue depth used by the benchmark (byte rings get room for as many items) */
+#define BENCH_DEPTH           16
+
+/** Byte ring bookkeeping allowance per record (header and alignment) */
+#define BENCH_RING_OVERHEAD   32
+
+/** Largest number of producer (and consumer) threads in the scaling run */
+#define BENCH_MAX_THREADS     16
+
+/** Items per os_queue_send_n() / os_queue_recv_n() call in the batched run */
+#define BENCH_BATCH           8
+
+/** Largest item: a full payload passed by value */
+#define BENCH_ITEM_MAX        (MAX_PAYLOAD_SIZE + sizeof(size_t))
+
+
+/**
+ * @brief Benchmark run parameters shared by producers and consumers.
+ */
+typedef struct {
+	os_queue_t q;       /**< Queue under test */
+	size_t items;       /**< Number of items per thread */
+	size_t item_size;   /**< Queue item size */
+	bool check_order;   /**< Verify FIFO order (single producer/consumer only) */
+	size_t batch;       /**< Items per queue call (1 = os_queue_send/recv, 0 = in place) */
+	bool ring;          /**< Byte ring, accessed with os_ring_*() (in place only) */
+} bench_ctx_t;
+
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+/**
+ * @brief Producer thread: sends numbered items.
+ */
+static void* producer(void* arg)
+{
+	bench_ctx_t* c = arg;
+	uint8_t items[BENCH_BATCH][BENCH_ITEM_MAX] = {{0}};
+
+	if (c->batch == 0) {
+		// Only the bytes the item really carries are written
+		for (size_t i = 0; i < c->items; i++) {
+			void* slot = c->ring ? os_ring_reserve(c->q, c->item_size, OS_WAIT_FOREVER)
+			                     : os_queue_reserve(c->q, OS_WAIT_FOREVER);
+			memcpy(slot, &i, sizeof(i));
+			if (c->ring) os_ring_commit(c->q, slot, c->item_size);
+			else os_queue_commit(c->q, slot);
+		}
+		return NULL;
+	}
+
+	if (c->batch == 1) {
+		for (size_t i = 0; i < c->items; i++) {
+			memcpy(items[0], &i, sizeof(i));
+			os_queue_send(c->q, items[0], OS_WAIT_FOREVER);
+		}
+		return NULL;
+	}
+
+	// Items of a batch must be packed back to back at the queue item size
+	size_t isz = c->item_size;
+	for (size_t i = 0; i < c->items; ) {
+		size_t n = (c->items - i < c->batch) ? c->items - i : c->batch;
+		for (size_t j = 0; j < n; j++) {
+			size_t v = i + j;
+			memcpy((uint8_t*)items + j * isz, &v, sizeof(v));
+		}
+		for (size_t sent = 0; sent < n; ) {
+			sent += os_queue_send_n(c->q, (uint8_t*)items + sent * isz, n - sent, OS_WAIT_FOREVER);
+		}
+		i += n;
+	}
+	return NULL;
+}
+
+
+/**
+ * @brief Consumer thread: receives items and optionally checks their order.
+ */
+static void* consumer(void* arg)
+{
+	bench_ctx_t* c = arg;
+	uint8_t items[BENCH_BATCH][BENCH_ITEM_MAX] = {{0}};
+
+	if (c->batch == 0) {
+		for (size_t i = 0; i < c->items; i++) {
+			const void* slot = c->ring ? os_ring_peek(c->q, NULL, OS_WAIT_FOREVER)
+			                           : os_queue_peek(c->q, OS_WAIT_FOREVER);
+			size_t v;
+			memcpy(&v, slot, sizeof(v));
+			if (c->ring) os_ring_release(c->q, slot);
+			else os_queue_release(c->q, slot);
+			if (c->check_order && v != i) {
+				printf("ERROR: out of order item %zu (expected %zu)\n", v, i);
+				exit(EXIT_FAILURE);
+			}
+		}
+		return NULL;
+	}
+
+	for (size_t i = 0; i < c->items; ) {
+		size_t n = (c->batch == 1)
+		         ? (size_t)os_queue_recv(c->q, items[0], OS_WAIT_FOREVER)
+		         : os_queue_recv_n(c->q, items, c->batch, OS_WAIT_FOREVER);
+		for (size_t j = 0; j < n; j++, i++) {
+			size_t v;
+			memcpy(&v, (uint8_t*)items + j * c->item_size, sizeof(v));
+			if (c->check_order && v != i) {
+				printf("ERROR: out of order item %zu (expected %zu)\n", v, i);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	return NULL;
+}
+
+
+/**
+ * @brief Run @p threads producers and as many consumers over a queue.
+ *
+ * @param label Queue flavour name for the report.
+ * @param q Queue under test.
+ * @param item_size Queue item size (for the report).
+ * @param threads Number of producers, and of consumers.
+ * @param items Total number of items to transfer.
+ * @param batch Items per queue call (1 for os_queue_send/recv, 0 for in-place access).
+ */
+static void bench_run(const char* label, os_queue_t q, size_t item_size,
+                      int threads, size_t items, size_t batch)
+{
+	bench_ctx_t c = { q, items / (size_t)threads, item_size, threads == 1, batch,
+	                  strcmp(label, "ring") == 0 };
+	pthread_t tp[BENCH_MAX_THREADS], tc[BENCH_MAX_THREADS];
+
+	if (!q) {
+		printf("%-8s %6zu B  %2d x %-2d  queue creation failed\n",
+		       label, item_size, threads, threads);
+		return;
+	}
+
+	uint64_t t0 = now_ns();
+	for (int i = 0; i < threads; i++) pthread_create(&tc[i], NULL, consumer, &c);
+	for (int i = 0; i < threads; i++) pthread_create(&tp[i], NULL, producer, &c);
+	for (int i = 0; i < threads; i++) pthread_join(tp[i], NULL);
+	for (int i = 0; i < threads; i++) pthread_join(tc[i], NULL);
+	uint64_t dt = now_ns() - t0;
+
+	size_t total = c.items * (size_t)threads;
+	printf("%-8s %6zu B  %2d x %-2d  %10.2f Mitems/s  %8.1f ns/item\n",
+	       label, item_size, threads, threads,
+	       (double)total * 1e3 / (double)dt, (double)dt / (double)total);
+}
+
+
+/**
+ * @brief Benchmark entry point.
+ */
+int main(int argc, char* argv[])
+{
+	size_t items = (argc > 1) ? strtoull(argv[1], NULL, 10) : BENCH_ITEMS_DEFAULT;
+	const size_t sizes[] = { sizeof(size_t), BENCH_ITEM_MAX };
+
+	printf("===== OSAL queue benchmark: 1 producer / 1 consumer, depth %d, %zu items =====\n",
+	       BENCH_DEPTH, items);
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		bench_run("locked", os_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, 1);
+		bench_run("spsc", os_spsc_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, 1);
+		bench_run("mpmc", os_mpmc_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, 1);
+	}
+
+	printf("\n===== OSAL queue benchmark: N producers / N consumers, depth %d, %zu items =====\n",
+	       BENCH_DEPTH, items);
+
+	for (int n = 1; n <= BENCH_MAX_THREADS; n *= 2) {
+		bench_run("locked", os_queue_create(BENCH_DEPTH, BENCH_ITEM_MAX),
+		          BENCH_ITEM_MAX, n, items, 1);
+		bench_run("mpmc", os_mpmc_queue_create(BENCH_DEPTH, BENCH_ITEM_MAX),
+		          BENCH_ITEM_MAX, n, items, 1);
+	}
+
+	printf("\n===== OSAL queue benchmark: 1 producer / 1 consumer, batches of %d, depth %d, %zu items =====\n",
+	       BENCH_BATCH, BENCH_DEPTH, items);
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		bench_run("locked", os_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, BENCH_BATCH);
+		bench_run("spsc", os_spsc_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, BENCH_BATCH);
+		bench_run("mpmc", os_mpmc_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, BENCH_BATCH);
+	}
+
+	printf("\n===== OSAL queue benchmark: 1 producer / 1 consumer, in place (reserve/commit, peek/release), depth %d, %zu items =====\n",
+	       BENCH_DEPTH, items);
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		bench_run("locked", os_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, 0);
+		bench_run("spsc", os_spsc_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, 0);
+		bench_run("mpmc", os_mpmc_queue_create(BENCH_DEPTH, sizes[i]), sizes[i], 1, items, 0);
+		bench_run("ring", os_ring_create(BENCH_DEPTH * (sizes[i] + BENCH_RING_OVERHEAD)),
+		          sizes[i], 1, items, 0);
+	}
+
+	return EXIT_SUCCESS;
+}
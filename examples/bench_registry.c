@@ -0,0 +1,148 @@
+/**
+ * @file    bench_registry.c
+ * @brief   Function registry lookup microbenchmark.
+ *
+ * @details Registers 10, 100 and 1000 methods in turn and measures the
+ * per-lookup cost of the name lookup every incoming request goes through
+ * (rpc_trans_find_fn(): lock-free, hash-indexed), next to a linear scan of
+ * the same names under a mutex (the lookup the registry used before):
+ *          - hits: names cycled through in registration order
+ *          - misses: names that are not registered
+ *
+ * @usage   ./bench_registry [lookups]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rpc_osal.h"
+#include "rpc_transport.h"
+
+/** Default number of lookups per measurement */
+#define BENCH_LOOKUPS_DEFAULT  2000000
+
+/** Largest registry size measured */
+#define BENCH_METHODS_MAX      1000
+
+/** Distinct unregistered names used for misses */
+#define BENCH_MISS_NAMES       64
+
+/** Method names ("method_0000", ...) and unregistered names ("absent_00", ...) */
+static char s_names[BENCH_METHODS_MAX][16];
+static char s_miss[BENCH_MISS_NAMES][16];
+
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+/**
+ * @brief Handler registered under every benchmark name (never called).
+ */
+static int handler_fn_nop(const uint8_t* args, uint16_t alen,
+                          uint8_t* out, uint16_t out_capacity,
+                          uint16_t* out_len, uint32_t timeout_ms)
+{
+	(void)args; (void)alen; (void)out; (void)out_capacity; (void)timeout_ms;
+	*out_len = 0;
+	return RPC_SUCCESS;
+}
+
+
+/**
+ * @brief Baseline: linear scan of the first @p count names under a mutex.
+ */
+static rpc_fn_t scan_find(os_mutex_t m, size_t count, const char* name)
+{
+	rpc_fn_t fn = NULL;
+
+	os_mutex_lock(m);
+	for (size_t i = 0; i < count; i++) {
+		if (strncmp(s_names[i], name, MAX_FUNC_NAME_LEN) == 0) {
+			fn = handler_fn_nop;
+			break;
+		}
+	}
+	os_mutex_unlock(m);
+	return fn;
+}
+
+
+/**
+ * @brief Mean cost (ns) of @p lookups lookups cycling through @p names.
+ *
+ * @param m Mutex of the linear scan, NULL to measure rpc_trans_find_fn().
+ * @param count Registered methods (scan length of the baseline).
+ * @param names Names to look up.
+ * @param n Number of @p names.
+ * @param hit Whether the names are registered (result is verified).
+ */
+static double bench_lookup(os_mutex_t m, size_t count, char (*names)[16], size_t n,
+                           bool hit, size_t lookups)
+{
+	size_t found = 0;
+	uint64_t t0 = now_ns();
+	for (size_t i = 0; i < lookups; i++) {
+		const char* name = names[i % n];
+		rpc_fn_t fn = m ? scan_find(m, count, name) : rpc_trans_find_fn(name);
+		found += (fn != NULL);
+	}
+	uint64_t t = now_ns() - t0;
+
+	if (found != (hit ? lookups : 0)) {
+		printf("lookup result mismatch: %zu of %zu found\n", found, lookups);
+		exit(EXIT_FAILURE);
+	}
+	return (double)t / (double)lookups;
+}
+
+
+/**
+ * @brief Benchmark entry point.
+ */
+int main(int argc, char* argv[])
+{
+	size_t lookups = (argc > 1) ? strtoull(argv[1], NULL, 10) : BENCH_LOOKUPS_DEFAULT;
+	static const size_t sizes[] = { 10, 100, 1000 };
+	size_t registered = 0;
+
+	if (lookups == 0) lookups = BENCH_LOOKUPS_DEFAULT;
+
+	rpc_trans_init(RPC_RUNTIME_THREADED, false, RPC_SCHED_SHARED);
+	os_mutex_t scan_mtx = os_mutex_create();
+
+	for (size_t i = 0; i < BENCH_METHODS_MAX; i++)
+		snprintf(s_names[i], sizeof(s_names[i]), "method_%04zu", i);
+	for (size_t i = 0; i < BENCH_MISS_NAMES; i++)
+		snprintf(s_miss[i], sizeof(s_miss[i]), "absent_%02zu", i);
+
+	printf("===== Function registry lookup, %zu lookups per run (ns/lookup) =====\n", lookups);
+	printf("%8s  %10s  %10s  %10s  %10s\n", "methods", "hash_hit", "hash_miss", "scan_hit", "scan_miss");
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		for (; registered < sizes[s]; registered++) {
+			if (register_fn(s_names[registered], handler_fn_nop) != RPC_SUCCESS) {
+				printf("registration of %s failed\n", s_names[registered]);
+				return EXIT_FAILURE;
+			}
+		}
+
+		double hash_hit = bench_lookup(NULL, registered, s_names, registered, true, lookups);
+		double hash_miss = bench_lookup(NULL, registered, s_miss, BENCH_MISS_NAMES, false, lookups);
+		double scan_hit = bench_lookup(scan_mtx, registered, s_names, registered, true, lookups);
+		double scan_miss = bench_lookup(scan_mtx, registered, s_miss, BENCH_MISS_NAMES, false, lookups);
+
+		printf("%8zu  %10.1f  %10.1f  %10.1f  %10.1f\n",
+		       registered, hash_hit, hash_miss, scan_hit, scan_miss);
+	}
+
+	return EXIT_SUCCESS;
+}
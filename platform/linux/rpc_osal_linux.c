@@ -5,30 +5,196 @@
  * This module provides Linux-specific implementation of OSAL using pthreads.
  */
 
+#define _GNU_SOURCE // pthread_setname_np, CPU affinity
+
 #include "rpc_osal.h"
+#include "rpc_log.h"
 #include <pthread.h>
 #include <time.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <sys/mman.h>
+
+/** Cache line size used to keep producer and consumer state apart */
+#define OS_CACHE_LINE 64
+
+/** Busy-poll iterations before a lock-free queue side yields the CPU (SMP only) */
+#define OS_SPIN_COUNT 128
+
+/** Yields before a lock-free queue side parks on its futex */
+#define OS_YIELD_COUNT 4
+
+/** Polls between clock reads in a time-bounded spin (os_sem_take_spin()) */
+#define OS_SPIN_CHECK 16
 
 /* --- Helpers --- */
 
 /**
- * @brief Convert relative timeout to absolute timespec.
+ * @brief Convert relative timeout to absolute CLOCK_MONOTONIC timespec.
+ *
+ * All timed waits use the monotonic clock, so deadlines do not move when
+ * the wall clock is adjusted.
  *
  * @param ts Output timespec structure.
  * @param timeout_ms Timeout in milliseconds.
+ * @return @p ts, or NULL for OS_WAIT_FOREVER (no deadline).
  */
-static void abs_time_ms(struct timespec* ts, uint32_t timeout_ms) {
-    clock_gettime(CLOCK_REALTIME, ts);
+static struct timespec* mono_deadline_ms(struct timespec* ts, uint32_t timeout_ms) {
+    if (timeout_ms == OS_WAIT_FOREVER) return NULL;
+    clock_gettime(CLOCK_MONOTONIC, ts);
     ts->tv_sec  += timeout_ms / 1000;
     ts->tv_nsec += (timeout_ms % 1000) * 1000000L;
     if (ts->tv_nsec >= 1000000000L) {
         ts->tv_sec += 1;
         ts->tv_nsec -= 1000000000L;
     }
+    return ts;
+}
+
+
+/**
+ * @brief Sleep while a futex word still holds the expected value.
+ *
+ * @param addr Futex word.
+ * @param val Expected value (returns at once if the word differs).
+ * @param deadline Absolute CLOCK_MONOTONIC deadline, NULL to wait forever.
+ * @return false if the deadline expired, true otherwise (woken or spurious).
+ */
+static bool futex_wait_until(atomic_uint* addr, unsigned val, const struct timespec* deadline) {
+    long r = syscall(SYS_futex, addr, FUTEX_WAIT_BITSET_PRIVATE, val,
+                     deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+    return !(r == -1 && errno == ETIMEDOUT);
+}
+
+
+/**
+ * @brief Wake up to @p n threads sleeping on a futex word.
+ */
+static void futex_wake(atomic_uint* addr, int n) {
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+
+/**
+ * @brief Initialize a condition variable timed against CLOCK_MONOTONIC.
+ */
+static void cond_init_monotonic(pthread_cond_t* c) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(c, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+
+/**
+ * @brief Wait on a monotonic condition variable until an absolute deadline.
+ *
+ * @param c Condition variable (created by cond_init_monotonic()).
+ * @param m Locked mutex.
+ * @param deadline Absolute CLOCK_MONOTONIC deadline, NULL to wait forever.
+ * @return false if the deadline expired, true otherwise.
+ */
+static bool cond_wait_until(pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* deadline) {
+    if (!deadline) return pthread_cond_wait(c, m) == 0;
+    return pthread_cond_timedwait(c, m, deadline) != ETIMEDOUT;
+}
+
+
+/**
+ * @brief CPU hint for busy-wait loops.
+ */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+
+/**
+ * @brief Busy-poll iterations worth doing before yielding.
+ *
+ * On a single CPU the other side cannot make progress while we spin, so
+ * spinning is skipped there and waiters go straight to yielding.
+ */
+static int spin_count(void) {
+    static atomic_int cached = -1;
+    int n = atomic_load_explicit(&cached, memory_order_relaxed);
+    if (n < 0) {
+        n = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? OS_SPIN_COUNT : 0;
+        atomic_store_explicit(&cached, n, memory_order_relaxed);
+    }
+    return n;
+}
+
+
+/* --- Object memory --- */
+
+/** Arena state (os_arena_init()) */
+static uint8_t* s_arena;          /**< Base of the arena, NULL without one */
+static size_t s_arena_size;       /**< Arena size in bytes */
+static atomic_size_t s_arena_top; /**< Bytes handed out */
+static uint32_t s_arena_flags;    /**< OS_ARENA_* flags */
+static atomic_bool s_sealed;      /**< Set by os_arena_seal() */
+
+
+/**
+ * @brief Round @p size up to whole cache lines.
+ */
+static inline size_t cache_round(size_t size) {
+    return (size + OS_CACHE_LINE - 1) & ~(size_t)(OS_CACHE_LINE - 1);
+}
+
+
+/**
+ * @brief Allocate zeroed memory aligned to a cache line.
+ *
+ * Carved from the arena when one is set up, from the heap otherwise.
+ */
+static void* mem_alloc(size_t size) {
+    size = cache_round(size ? size : 1);
+
+    if (atomic_load_explicit(&s_sealed, memory_order_relaxed))
+        RPC_LOG_ERROR("OSAL allocation of %zu bytes after initialization", size);
+
+    if (s_arena) {
+        size_t top = atomic_load_explicit(&s_arena_top, memory_order_relaxed);
+        while (top + size <= s_arena_size) {
+            if (atomic_compare_exchange_weak(&s_arena_top, &top, top + size))
+                return s_arena + top; // Zeroed and prefaulted by os_arena_init()
+        }
+        RPC_LOG_ERROR("OSAL arena exhausted (%zu bytes), %zu bytes from the heap",
+                      s_arena_size, size);
+    }
+
+    void* p = NULL;
+    if (posix_memalign(&p, OS_CACHE_LINE, size) != 0) return NULL;
+    memset(p, 0, size);
+    return p;
+}
+
+
+/**
+ * @brief Release memory from mem_alloc() (arena memory is never reused).
+ */
+static void mem_free(void* p) {
+    if (s_arena && (uint8_t*)p >= s_arena && (uint8_t*)p < s_arena + s_arena_size) return;
+    free(p);
 }
 
 
@@ -41,218 +207,2479 @@ struct os_thread {
 
 
 /**
- * @brief Create a new thread (Linux implementation).
+ * @brief Apply scheduling policy, priority and CPU affinity to pthread attributes.
+ *
+ * @return true if real-time scheduling was requested.
  */
-os_thread_t os_thread_create(const char* name, // thread name (ignored)
-                             os_thread_fn fn, // thread function
-                             void* arg, // function argument
-                             uint16_t stack_size, // stack size
-                             uint8_t priority) // priority (ignored)
+static bool thread_attr_sched(pthread_attr_t* pa, const os_thread_attr_t* attr) {
+    if (attr->cpu_mask) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++) {
+            if (attr->cpu_mask & (1ULL << cpu)) CPU_SET(cpu, &set);
+        }
+        pthread_attr_setaffinity_np(pa, sizeof(set), &set);
+    }
+
+    if (attr->policy == OS_SCHED_DEFAULT) return false;
+
+    int policy = (attr->policy == OS_SCHED_RR) ? SCHED_RR : SCHED_FIFO;
+    int lo = sched_get_priority_min(policy);
+    int hi = sched_get_priority_max(policy);
+    struct sched_param sp = { .sched_priority = attr->priority };
+    if (sp.sched_priority < lo) sp.sched_priority = lo;
+    if (sp.sched_priority > hi) sp.sched_priority = hi;
+
+    pthread_attr_setinheritsched(pa, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(pa, policy);
+    pthread_attr_setschedparam(pa, &sp);
+    return true;
+}
+
+
+/**
+ * @brief Create a new thread with explicit attributes (Linux implementation).
+ */
+os_thread_t os_thread_create_ex(const os_thread_attr_t* attr,
+                                os_thread_fn fn,
+                                void* arg)
 {
-    (void)name;
-    (void)priority;
+    if (!attr || !fn) return NULL;
 
-    os_thread_t t = calloc(1, sizeof(*t));
+    os_thread_t t = mem_alloc(sizeof(*t));
     if (!t) return NULL;
 
-    pthread_attr_t attr;
-    pthread_attr_init(&attr); // priority (ignored)
-    if (stack_size > 0)
-        pthread_attr_setstacksize(&attr, stack_size); // Set stack size
+    pthread_attr_t pa;
+    pthread_attr_init(&pa);
+    if (attr->stack_size >= PTHREAD_STACK_MIN) // smaller stacks keep the default
+        pthread_attr_setstacksize(&pa, attr->stack_size); // Set stack size
+    bool rt = thread_attr_sched(&pa, attr);
+
+    int r = pthread_create(&t->tid, &pa, fn, arg);
+    if (r == EPERM && rt) {
+        // Real-time scheduling needs CAP_SYS_NICE / RLIMIT_RTPRIO: fall back
+        RPC_LOG_INFO("Real-time scheduling not permitted for thread %s, using default",
+                     attr->name ? attr->name : "?");
+        pthread_attr_setinheritsched(&pa, PTHREAD_INHERIT_SCHED);
+        r = pthread_create(&t->tid, &pa, fn, arg);
+    }
+    pthread_attr_destroy(&pa); // Freeing attribute resources
 
-    if (pthread_create(&t->tid, &attr, fn, arg) != 0) { // Basic thread creation
-        free(t);
+    if (r != 0) {
+        mem_free(t);
         return NULL;
     }
 
-    pthread_attr_destroy(&attr); // Freeing attribute resources
+    if (attr->name) {
+        char name[16]; // Linux limit including the terminator
+        snprintf(name, sizeof(name), "%s", attr->name);
+        pthread_setname_np(t->tid, name);
+    }
+
     return t;
 }
 
 
+/**
+ * @brief Let a thread's resources be reclaimed when it returns (Linux implementation).
+ */
+void os_thread_detach(os_thread_t t) {
+    if (!t) return;
+
+    pthread_detach(t->tid);
+    mem_free(t);
+}
+
+
+/**
+ * @brief Create a new thread (Linux implementation).
+ *
+ * A non-zero priority requests SCHED_FIFO at that priority.
+ */
+os_thread_t os_thread_create(const char* name, // thread name
+                             os_thread_fn fn, // thread function
+                             void* arg, // function argument
+                             uint16_t stack_size, // stack size
+                             uint8_t priority) // priority (0 = default scheduling)
+{
+    os_thread_attr_t attr = {
+        .name = name,
+        .stack_size = stack_size,
+        .policy = priority ? OS_SCHED_FIFO : OS_SCHED_DEFAULT,
+        .priority = priority,
+        .cpu_mask = 0,
+    };
+    return os_thread_create_ex(&attr, fn, arg);
+}
+
+
 /* ---------- Queues (ring buffer) ---------- */
 
-/** Queue structure for Linux implementation */
-struct os_queue {
-    uint8_t* buf;             /**< Data buffer */
-    size_t item_size;         /**< Size of one item */
-    size_t capacity;          /**< Maximum capacity */
-    size_t head;              /**< Read index */
-    size_t tail;              /**< Write index */
-    size_t count;             /**< Current item count */
-    pthread_mutex_t m;        /**< Mutex for synchronization */
-    pthread_cond_t not_empty; /**< Condition variable: not empty */
-    pthread_cond_t not_full;  /**< Condition variable: not full */
+/** Queue flavours sharing the os_queue_t handle */
+typedef enum {
+    QUEUE_LOCKED, /**< Mutex + condition variables, any number of threads */
+    QUEUE_SPSC,   /**< Lock-free, one producer and one consumer */
+    QUEUE_MPMC,   /**< Lock-free bounded MPMC (Vyukov), any number of threads */
+    QUEUE_RING    /**< Lock-free byte ring of variable-length records, one consumer */
+} queue_kind_t;
+
+
+/**
+ * @brief Lock-free SPSC ring state.
+ *
+ * Head and tail are free-running counters, each on its own cache line so the
+ * producer and consumer never write to the same line. The park flags are
+ * futex words on a third line, written only when a side goes to sleep.
+ */
+struct spsc_state {
+    alignas(OS_CACHE_LINE) atomic_size_t head; /**< Read counter (consumer) */
+    size_t tail_cache;                         /**< Consumer's last seen tail */
+
+    alignas(OS_CACHE_LINE) atomic_size_t tail; /**< Write counter (producer) */
+    size_t head_cache;                         /**< Producer's last seen head */
+
+    alignas(OS_CACHE_LINE) atomic_uint consumer_parked; /**< 1 while consumer sleeps */
+    atomic_uint producer_parked;                        /**< 1 while producer sleeps */
 };
 
 
 /**
- * @brief Create a new queue (Linux implementation).
+ * @brief Event count used to park blocked MPMC senders or receivers.
+ *
+ * Waiters register themselves and sample @c epoch before re-checking the
+ * queue; notifiers bump @c epoch only when somebody is registered, so the
+ * uncontended path never enters the kernel.
  */
-os_queue_t os_queue_create(size_t length, size_t item_size) {
-    struct os_queue* q = calloc(1, sizeof(*q));
-    if (!q) return NULL;
+struct eventcount {
+    atomic_uint epoch;   /**< Futex word, incremented on every notification */
+    atomic_uint waiters; /**< Number of threads about to sleep or sleeping */
+};
 
-    q->buf = malloc(length * item_size);
-    if (!q->buf) { free(q); return NULL; }
 
-    q->item_size = item_size; q->capacity = length;
-    pthread_mutex_init(&q->m, NULL);
-    pthread_cond_init (&q->not_empty, NULL);
-    pthread_cond_init (&q->not_full, NULL);
-    return q;
+/**
+ * @brief Lock-free bounded MPMC ring state (Dmitry Vyukov's algorithm).
+ *
+ * Every cell carries a sequence number telling whether it is free for the
+ * producer claiming position @c pos (seq == pos) or holds data for the
+ * consumer claiming it (seq == pos + 1). Positions are claimed with CAS.
+ */
+struct mpmc_state {
+    alignas(OS_CACHE_LINE) atomic_size_t enqueue_pos; /**< Next position to write */
+    alignas(OS_CACHE_LINE) atomic_size_t dequeue_pos; /**< Next position to read */
+    alignas(OS_CACHE_LINE) struct eventcount not_empty; /**< Parked receivers */
+    alignas(OS_CACHE_LINE) struct eventcount not_full;  /**< Parked senders */
+    size_t stride;                                      /**< Cell size in bytes */
+};
+
+
+/**
+ * @brief Byte ring state.
+ *
+ * Positions are free-running byte counters. Producers claim space by
+ * advancing @c tail with CAS; the single consumer advances @c head after
+ * zeroing the bytes it consumed, so a header slot reads as "not ready"
+ * until its producer commits it.
+ */
+struct ring_state {
+    alignas(OS_CACHE_LINE) atomic_size_t tail;          /**< Claimed up to (producers) */
+    _Atomic uint64_t committed;                         /**< Records committed */
+    alignas(OS_CACHE_LINE) atomic_size_t head;          /**< Consumed up to (consumer) */
+    _Atomic uint64_t released;                          /**< Records released */
+    alignas(OS_CACHE_LINE) struct eventcount not_empty; /**< Parked consumer */
+    alignas(OS_CACHE_LINE) struct eventcount not_full;  /**< Parked producers */
+};
+
+
+/* ---------- Lock Statistics ---------- */
+
+/**
+ * @brief Contention statistics of one lock (RPC_MUTEX_STATS).
+ *
+ * Kept for os_mutex objects and for the internal locks of locked queues
+ * and timer wheels. Every counter is written by the lock holder only, so
+ * plain relaxed stores suffice; readers see a consistent-enough snapshot.
+ */
+struct lock_stats {
+    const char* name;                 /**< Lock name, NULL if unnamed */
+    struct lock_stats* next;          /**< Next named lock */
+    _Atomic uint64_t acquisitions;    /**< Times the lock was taken */
+    _Atomic uint64_t contended;       /**< Acquisitions that found it held */
+    _Atomic uint64_t wait_ns;         /**< Time spent waiting in those */
+    _Atomic uint64_t max_wait_ns;     /**< Longest wait */
+    _Atomic uint64_t hold_samples;    /**< Sampled holds */
+    _Atomic uint64_t hold_ns;         /**< Total time of the sampled holds */
+    _Atomic uint64_t max_hold_ns;     /**< Longest sampled hold */
+    uint64_t hold_start;              /**< Start of the current sampled hold, 0 if not sampled */
+};
+
+/** Named locks, in naming order */
+static struct lock_stats* s_named_locks;
+static pthread_mutex_t s_named_locks_m = PTHREAD_MUTEX_INITIALIZER;
+
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
 
 /**
- * @brief Send an item to the queue (Linux implementation).
+ * @brief Add @p v to a holder-owned counter.
  */
-bool os_queue_send(os_queue_t q, const void* item, uint32_t timeout_ms) {
-    if (!q || !item) return false;
+static inline void lock_stats_add(_Atomic uint64_t* c, uint64_t v) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + v, memory_order_relaxed);
+}
 
-    pthread_mutex_lock(&q->m); // Capture the mutex
 
-    // We wait until a place becomes available
-    while (q->count == q->capacity) {
-        if (timeout_ms == 0) { pthread_mutex_unlock(&q->m); return false; } // We are not waiting
-        struct timespec ts;
-        abs_time_ms(&ts, timeout_ms);
-        int r = pthread_cond_timedwait(&q->not_full, &q->m, &ts);
-        if (r == ETIMEDOUT) { pthread_mutex_unlock(&q->m); return false; }
+/**
+ * @brief Raise a holder-owned maximum to @p v.
+ */
+static inline void lock_stats_max(_Atomic uint64_t* c, uint64_t v) {
+    if (v > atomic_load_explicit(c, memory_order_relaxed))
+        atomic_store_explicit(c, v, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Take a lock, counting contention.
+ *
+ * A trylock first keeps the uncontended path free of clock reads; only an
+ * acquisition that has to wait is timed. Holds are timed for every
+ * RPC_MUTEX_STATS_SAMPLE-th acquisition and for every contended one.
+ */
+static void lock_take(pthread_mutex_t* m, struct lock_stats* s) {
+    if (!RPC_MUTEX_STATS) { pthread_mutex_lock(m); return; }
+
+    uint64_t now = 0;
+    if (pthread_mutex_trylock(m) != 0) {
+        uint64_t t0 = mono_ns();
+        pthread_mutex_lock(m);
+        now = mono_ns();
+        lock_stats_add(&s->contended, 1);
+        lock_stats_add(&s->wait_ns, now - t0);
+        lock_stats_max(&s->max_wait_ns, now - t0);
     }
 
-    // Copy data to buffer
-    memcpy(q->buf + q->tail * q->item_size, item, q->item_size);
-    q->tail = (q->tail + 1) % q->capacity; // Ring buffer
-    q->count++;
+    uint64_t n = atomic_load_explicit(&s->acquisitions, memory_order_relaxed) + 1;
+    atomic_store_explicit(&s->acquisitions, n, memory_order_relaxed);
+    if (!now && n % RPC_MUTEX_STATS_SAMPLE == 0) now = mono_ns();
+    s->hold_start = now;
+}
+
 
-    pthread_cond_signal(&q->not_empty); // Signal: "data appeared!"
-    pthread_mutex_unlock(&q->m); // Release the mutex
-    return true;
+/**
+ * @brief Release a lock taken with lock_take(), recording a sampled hold.
+ */
+static void lock_drop(pthread_mutex_t* m, struct lock_stats* s) {
+    if (RPC_MUTEX_STATS && s->hold_start) {
+        uint64_t held = mono_ns() - s->hold_start;
+        s->hold_start = 0;
+        lock_stats_add(&s->hold_samples, 1);
+        lock_stats_add(&s->hold_ns, held);
+        lock_stats_max(&s->max_hold_ns, held);
+    }
+    pthread_mutex_unlock(m);
 }
 
 
 /**
- * @brief Receive an item from the queue (Linux implementation).
+ * @brief Wait on a condition variable under a lock taken with lock_take().
+ *
+ * The lock is given up while waiting, so a sampled hold is dropped rather
+ * than counted with the wait in it.
  */
-bool os_queue_recv(os_queue_t q, void* item, uint32_t timeout_ms) {
-    if (!q || !item) return false;
+static bool lock_wait(pthread_cond_t* c, pthread_mutex_t* m, struct lock_stats* s,
+                      const struct timespec* deadline) {
+    s->hold_start = 0;
+    return cond_wait_until(c, m, deadline);
+}
 
-    pthread_mutex_lock(&q->m); // Release the mutex
 
-    // Wait for the data to appear
-    while (q->count == 0) {
-        if (timeout_ms == 0) { pthread_mutex_unlock(&q->m); return false; }
-        struct timespec ts;
-        abs_time_ms(&ts, timeout_ms);
-        int r = pthread_cond_timedwait(&q->not_empty, &q->m, &ts);
-        if (r == ETIMEDOUT) { pthread_mutex_unlock(&q->m); return false; }
+/**
+ * @brief Name a lock and include it in os_mutex_list_stats().
+ */
+static void lock_stats_set_name(struct lock_stats* s, const char* name) {
+    pthread_mutex_lock(&s_named_locks_m);
+    if (!s->name) { // Append on first naming only
+        struct lock_stats** tail = &s_named_locks;
+        while (*tail) tail = &(*tail)->next;
+        *tail = s;
     }
+    s->name = name;
+    pthread_mutex_unlock(&s_named_locks_m);
+}
 
-    // Copy data from the buffer
-    memcpy(item, q->buf + q->head * q->item_size, q->item_size);
-    q->head = (q->head + 1) % q->capacity; q->count--;
 
-    pthread_cond_signal(&q->not_full); // Signal: "a place has appeared!"
-    pthread_mutex_unlock(&q->m); // Release the mutex
-    return true;
+/**
+ * @brief Snapshot of a lock's statistics.
+ */
+static void lock_stats_get(const struct lock_stats* s, os_mutex_stats_t* st) {
+    memset(st, 0, sizeof(*st));
+    st->name = s->name;
+    st->acquisitions = atomic_load_explicit(&s->acquisitions, memory_order_relaxed);
+    st->contended = atomic_load_explicit(&s->contended, memory_order_relaxed);
+    st->wait_ns = atomic_load_explicit(&s->wait_ns, memory_order_relaxed);
+    st->max_wait_ns = atomic_load_explicit(&s->max_wait_ns, memory_order_relaxed);
+    st->hold_samples = atomic_load_explicit(&s->hold_samples, memory_order_relaxed);
+    st->hold_ns = atomic_load_explicit(&s->hold_ns, memory_order_relaxed);
+    st->max_hold_ns = atomic_load_explicit(&s->max_hold_ns, memory_order_relaxed);
 }
 
 
-/* ---------- Binary Semaphores ---------- */
+/* ---------- Queue Statistics ---------- */
 
-/** Binary semaphore structure for Linux implementation */
-struct os_sem {
-    pthread_mutex_t m;  /**< Mutex for synchronization */
-    pthread_cond_t  c;  /**< Condition variable for waiting */
-    int count;          /**< Semaphore state: 0 - busy, 1 - free */
+/**
+ * @brief Queue statistics (RPC_QUEUE_STATS).
+ *
+ * Sent/received totals are not kept here: they are the free-running
+ * positions of each queue flavour. Residence time is measured for every
+ * RPC_QUEUE_STATS_SAMPLE-th position: the producer stamps the slot before
+ * publishing it and the consumer reads the stamp before releasing it, so
+ * the stamp array needs no synchronization of its own.
+ */
+struct queue_stats {
+    alignas(OS_CACHE_LINE) const char* name;  /**< Queue name, NULL if unnamed */
+    struct os_queue* next;                    /**< Next named queue */
+    uint64_t* stamp;                          /**< Enqueue time (ns) per slot, sampled slots only */
+    atomic_size_t high_water;                 /**< Highest depth seen */
+    _Atomic uint64_t blocked_sends;           /**< Sends that waited for a free slot */
+    _Atomic uint64_t blocked_ns;              /**< Time spent in those waits */
+    _Atomic uint64_t send_timeouts;           /**< Sends that found no free slot in time */
+    _Atomic uint64_t recv_timeouts;           /**< Timed receives that found no item */
+    _Atomic uint64_t res_samples;             /**< Residence samples taken */
+    _Atomic uint64_t res_ns;                  /**< Sum of sampled residence times */
+    _Atomic uint64_t res_hist[OS_QUEUE_HIST_BUCKETS]; /**< Residence histogram (log2 us) */
 };
 
 
 /**
- * @brief Create a binary semaphore (Linux implementation).
+ * @brief Mutex-protected ring state.
  */
-os_sem_t os_sem_create_binary(void) {
-    struct os_sem* s = calloc(1, sizeof(*s));
-    if (!s) return NULL;
-    pthread_mutex_init(&s->m, NULL);
-    pthread_cond_init (&s->c, NULL);
-    s->count = 0;
-    return s;
-}
+struct locked_state {
+    size_t head;              /**< Read index */
+    size_t tail;              /**< Write index */
+    size_t count;             /**< Current item count */
+    size_t sent;              /**< Items sent */
+    size_t received;          /**< Items received */
+    pthread_mutex_t m;        /**< Mutex for synchronization */
+    struct lock_stats lock;   /**< Contention statistics of @c m (RPC_MUTEX_STATS) */
+    pthread_cond_t not_empty; /**< Condition variable: not empty */
+    pthread_cond_t not_full;  /**< Condition variable: not full */
+};
 
 
 /**
- * @brief Take a binary semaphore (Linux implementation).
+ * @brief Queue structure for Linux implementation.
+ *
+ * A queue only ever has the state of its own flavour, selected by @c kind.
  */
-bool os_sem_take(os_sem_t s, uint32_t timeout_ms) {
-    pthread_mutex_lock(&s->m); // Capture the mutex
+struct os_queue {
+    queue_kind_t kind;        /**< Queue flavour */
+    uint8_t* buf;             /**< Data buffer */
+    size_t item_size;         /**< Size of one item */
+    size_t capacity;          /**< Maximum capacity */
+    union {
+        struct locked_state locked; /**< State of QUEUE_LOCKED queues */
+        struct spsc_state spsc;     /**< State of QUEUE_SPSC queues */
+        struct mpmc_state mpmc;     /**< State of QUEUE_MPMC queues */
+        struct ring_state ring;     /**< State of QUEUE_RING queues */
+    };
+    struct queue_stats stats; /**< Statistics (RPC_QUEUE_STATS) */
+};
 
-    // Wait until the semaphore is free
-    while (s->count == 0) { // While busy (count == 0)
-        if (timeout_ms == 0) { pthread_mutex_unlock(&s->m); return false; } // Non-blocking mode
-        struct timespec ts;
-        abs_time_ms(&ts, timeout_ms);
-        int r = pthread_cond_timedwait(&s->c, &s->m, &ts);
-        if (r == ETIMEDOUT) { pthread_mutex_unlock(&s->m); return false; } // Wait with timeout
-    }
 
-    s->count = 0; // Capture the semaphore!
-    pthread_mutex_unlock(&s->m);  // Release the mutex
-    return true;
+static size_t spsc_send_n(os_queue_t q, const void* items, size_t n, uint32_t timeout_ms);
+static size_t spsc_recv_n(os_queue_t q, void* items, size_t n, uint32_t timeout_ms);
+static size_t mpmc_send_n(os_queue_t q, const void* items, size_t n, uint32_t timeout_ms);
+static size_t mpmc_recv_n(os_queue_t q, void* items, size_t n, uint32_t timeout_ms);
+
+
+/**
+ * @brief Copy @p n items into the ring starting at slot @p idx, wrapping around.
+ */
+static void ring_put(os_queue_t q, size_t idx, const void* items, size_t n) {
+    size_t first = q->capacity - idx;
+    if (first > n) first = n;
+    memcpy(q->buf + idx * q->item_size, items, first * q->item_size);
+    memcpy(q->buf, (const uint8_t*)items + first * q->item_size, (n - first) * q->item_size);
 }
 
 
 /**
- * @brief Give a binary semaphore (Linux implementation).
+ * @brief Copy @p n items out of the ring starting at slot @p idx, wrapping around.
  */
-void os_sem_give(os_sem_t s) {
-    pthread_mutex_lock(&s->m); // Release the mutex
-    s->count = 1; // Release the semaphore!
-    pthread_cond_signal(&s->c); // Signal to those waiting
-    pthread_mutex_unlock(&s->m); // Release the mutex
+static void ring_get(os_queue_t q, size_t idx, void* items, size_t n) {
+    size_t first = q->capacity - idx;
+    if (first > n) first = n;
+    memcpy(items, q->buf + idx * q->item_size, first * q->item_size);
+    memcpy((uint8_t*)items + first * q->item_size, q->buf, (n - first) * q->item_size);
 }
 
 
-/* ---------- Mutex ---------- */
+/* ---------- Queue Statistics ---------- */
 
-/** Mutex structure for Linux implementation */
-struct os_mutex {
-	pthread_mutex_t m;
-};
+/** Named queues, in naming order */
+static struct os_queue* s_named_queues;
+static pthread_mutex_t s_named_queues_m = PTHREAD_MUTEX_INITIALIZER;
 
 
 /**
- * @brief Create a mutex (Linux implementation).
+ * @brief Allocate the statistics state of a new queue.
+ *
+ * @return false if out of memory.
  */
-os_mutex_t os_mutex_create(void) {
-    os_mutex_t mu = calloc(1, sizeof(*mu));
-    if (!mu) return NULL;
-    pthread_mutex_init(&mu->m, NULL);
-    return mu;
+static bool queue_stats_init(os_queue_t q) {
+    if (!RPC_QUEUE_STATS) return true;
+    q->stats.stamp = mem_alloc(q->capacity * sizeof(uint64_t));
+    return q->stats.stamp != NULL;
 }
 
 
 /**
- * @brief Lock a mutex (Linux implementation).
+ * @brief First sampled position in [pos, pos + k), or pos + k if none.
  */
-void os_mutex_lock(os_mutex_t m)   { pthread_mutex_lock(&m->m); }
+static inline size_t queue_stats_first_sample(size_t pos, size_t k) {
+    size_t first = (pos + RPC_QUEUE_STATS_SAMPLE - 1) & ~(size_t)(RPC_QUEUE_STATS_SAMPLE - 1);
+    return (first - pos < k) ? first : pos + k;
+}
 
 
 /**
- * @brief Unlock a mutex (Linux implementation).
+ * @brief Producer side: stamp the sampled positions of [pos, pos + k).
+ *
+ * Must be called before the items are published.
  */
-void os_mutex_unlock(os_mutex_t m) { pthread_mutex_unlock(&m->m); }
+static void queue_stats_enqueue(os_queue_t q, size_t pos, size_t k) {
+    if (!RPC_QUEUE_STATS) return;
+    size_t p = queue_stats_first_sample(pos, k);
+    if (p == pos + k) return;
+    uint64_t now = mono_ns();
+    for (; p - pos < k; p += RPC_QUEUE_STATS_SAMPLE) q->stats.stamp[p % q->capacity] = now;
+}
 
 
-/* ---------- Misc ---------- */
+/**
+ * @brief Record one residence time sample of @p ns nanoseconds.
+ */
+static void queue_stats_residence(os_queue_t q, uint64_t ns) {
+    uint64_t us = ns / 1000;
+    int b = 0;
+    while (us && b < OS_QUEUE_HIST_BUCKETS - 1) { us >>= 1; b++; }
+    atomic_fetch_add_explicit(&q->stats.res_samples, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&q->stats.res_ns, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&q->stats.res_hist[b], 1, memory_order_relaxed);
+}
+
 
 /**
- * @brief Delay execution (Linux implementation).
+ * @brief Consumer side: record the residence time of the sampled positions of [pos, pos + k).
+ *
+ * Must be called after the items were acquired and before their slots are released.
  */
-void os_delay_ms(uint32_t ms) {
-    struct timespec ts;
-    ts.tv_sec = ms / 1000;
-    ts.tv_nsec = (ms % 1000) * 1000000L;
-    nanosleep(&ts, NULL);
+static void queue_stats_dequeue(os_queue_t q, size_t pos, size_t k) {
+    if (!RPC_QUEUE_STATS) return;
+    size_t p = queue_stats_first_sample(pos, k);
+    if (p == pos + k) return;
+    uint64_t now = mono_ns();
+    for (; p - pos < k; p += RPC_QUEUE_STATS_SAMPLE) {
+        queue_stats_residence(q, now - q->stats.stamp[p % q->capacity]);
+    }
+}
+
+
+/**
+ * @brief Raise the high-water mark to @p depth if it is higher.
+ */
+static inline void queue_stats_depth(os_queue_t q, size_t depth) {
+    if (!RPC_QUEUE_STATS) return;
+    size_t hw = atomic_load_explicit(&q->stats.high_water, memory_order_relaxed);
+    while (depth > hw &&
+           !atomic_compare_exchange_weak_explicit(&q->stats.high_water, &hw, depth,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+
+/**
+ * @brief Whether @p depth would raise the high-water mark (cheap pre-check).
+ */
+static inline bool queue_stats_above_hw(os_queue_t q, size_t depth) {
+    return RPC_QUEUE_STATS &&
+           depth > atomic_load_explicit(&q->stats.high_water, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Create a new queue (Linux implementation).
+ */
+os_queue_t os_queue_create(size_t length, size_t item_size) {
+    struct os_queue* q = mem_alloc(sizeof(*q));
+    if (!q) return NULL;
+
+    q->buf = mem_alloc(length * item_size);
+    if (!q->buf) { mem_free(q); return NULL; }
+
+    q->item_size = item_size; q->capacity = length;
+    if (!queue_stats_init(q)) { mem_free(q->buf); mem_free(q); return NULL; }
+    pthread_mutex_init(&q->locked.m, NULL);
+    cond_init_monotonic(&q->locked.not_empty);
+    cond_init_monotonic(&q->locked.not_full);
+    return q;
+}
+
+
+/**
+ * @brief Send up to @p n items to a locked queue under a single lock hold.
+ */
+static size_t locked_send_n(os_queue_t q, const void* items, size_t n, uint32_t timeout_ms) {
+    struct timespec ts;
+    const struct timespec* deadline = (timeout_ms != 0) ? mono_deadline_ms(&ts, timeout_ms) : NULL;
+
+    lock_take(&q->locked.m, &q->locked.lock); // Capture the mutex
+
+    // We wait until a place becomes available
+    while (q->locked.count == q->capacity) {
+        if (timeout_ms == 0) { lock_drop(&q->locked.m, &q->locked.lock); return 0; } // We are not waiting
+        if (!lock_wait(&q->locked.not_full, &q->locked.m, &q->locked.lock, deadline)) { lock_drop(&q->locked.m, &q->locked.lock); return 0; }
+    }
+
+    // Copy as many items as fit to the buffer
+    size_t k = q->capacity - q->locked.count;
+    if (k > n) k = n;
+    queue_stats_enqueue(q, q->locked.sent, k);
+    ring_put(q, q->locked.tail, items, k);
+    q->locked.tail = (q->locked.tail + k) % q->capacity; // Ring buffer
+    q->locked.count += k;
+    q->locked.sent += k;
+    queue_stats_depth(q, q->locked.count);
+
+    // Signal: "data appeared!" (every receiver may get an item)
+    if (k == 1) pthread_cond_signal(&q->locked.not_empty);
+    else pthread_cond_broadcast(&q->locked.not_empty);
+    lock_drop(&q->locked.m, &q->locked.lock); // Release the mutex
+    return k;
+}
+
+
+/**
+ * @brief Receive up to @p n items from a locked queue under a single lock hold.
+ */
+static size_t locked_recv_n(os_queue_t q, void* items, size_t n, uint32_t timeout_ms) {
+    struct timespec ts;
+    const struct timespec* deadline = (timeout_ms != 0) ? mono_deadline_ms(&ts, timeout_ms) : NULL;
+
+    lock_take(&q->locked.m, &q->locked.lock); // Capture the mutex
+
+    // Wait for the data to appear
+    while (q->locked.count == 0) {
+        if (timeout_ms == 0) { lock_drop(&q->locked.m, &q->locked.lock); return 0; }
+        if (!lock_wait(&q->locked.not_empty, &q->locked.m, &q->locked.lock, deadline)) { lock_drop(&q->locked.m, &q->locked.lock); return 0; }
+    }
+
+    // Copy everything available (up to n) from the buffer
+    size_t k = (q->locked.count < n) ? q->locked.count : n;
+    ring_get(q, q->locked.head, items, k);
+    queue_stats_dequeue(q, q->locked.received, k);
+    q->locked.head = (q->locked.head + k) % q->capacity;
+    q->locked.count -= k;
+    q->locked.received += k;
+
+    // Signal: "a place has appeared!" (every sender may get a slot)
+    if (k == 1) pthread_cond_signal(&q->locked.not_full);
+    else pthread_cond_broadcast(&q->locked.not_full);
+    lock_drop(&q->locked.m, &q->locked.lock); // Release the mutex
+    return k;
+}
+
+
+/**
+ * @brief Send an item to the queue (Linux implementation).
+ */
+bool os_queue_send(os_queue_t q, const void* item, uint32_t timeout_ms) {
+    return os_queue_send_n(q, item, 1, timeout_ms) == 1;
+}
+
+
+/**
+ * @brief Receive an item from the queue (Linux implementation).
+ */
+bool os_queue_recv(os_queue_t q, void* item, uint32_t timeout_ms) {
+    return os_queue_recv_n(q, item, 1, timeout_ms) == 1;
+}
+
+
+/**
+ * @brief Send up to @p n items with the queue flavour's own send.
+ */
+static size_t queue_send_n(os_queue_t q, const void* items, size_t n, uint32_t timeout_ms) {
+    if (q->kind == QUEUE_SPSC) return spsc_send_n(q, items, n, timeout_ms);
+    if (q->kind == QUEUE_MPMC) return mpmc_send_n(q, items, n, timeout_ms);
+    return locked_send_n(q, items, n, timeout_ms);
+}
+
+
+/**
+ * @brief Send up to @p n items to the queue (Linux implementation).
+ *
+ * With RPC_QUEUE_STATS a full queue is detected by a non-blocking attempt
+ * first, so only sends that really wait are counted and timed.
+ */
+size_t os_queue_send_n(os_queue_t q, const void* items, size_t n, uint32_t timeout_ms) {
+    if (!q || !items || n == 0 || q->kind == QUEUE_RING) return 0;
+    if (!RPC_QUEUE_STATS) return queue_send_n(q, items, n, timeout_ms);
+
+    size_t k = queue_send_n(q, items, n, OS_NO_WAIT);
+    if (k) return k;
+
+    if (timeout_ms != OS_NO_WAIT) {
+        uint64_t t0 = mono_ns();
+        k = queue_send_n(q, items, n, timeout_ms);
+        atomic_fetch_add_explicit(&q->stats.blocked_sends, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&q->stats.blocked_ns, mono_ns() - t0, memory_order_relaxed);
+    }
+    if (!k) atomic_fetch_add_explicit(&q->stats.send_timeouts, 1, memory_order_relaxed);
+    return k;
+}
+
+
+/**
+ * @brief Receive up to @p n items from the queue (Linux implementation).
+ */
+size_t os_queue_recv_n(os_queue_t q, void* items, size_t n, uint32_t timeout_ms) {
+    if (!q || !items || n == 0 || q->kind == QUEUE_RING) return 0;
+
+    size_t k;
+    if (q->kind == QUEUE_SPSC) k = spsc_recv_n(q, items, n, timeout_ms);
+    else if (q->kind == QUEUE_MPMC) k = mpmc_recv_n(q, items, n, timeout_ms);
+    else k = locked_recv_n(q, items, n, timeout_ms);
+
+    // Polling an empty queue is not a timeout
+    if (RPC_QUEUE_STATS && !k && timeout_ms != OS_NO_WAIT)
+        atomic_fetch_add_explicit(&q->stats.recv_timeouts, 1, memory_order_relaxed);
+    return k;
+}
+
+
+/**
+ * @brief Name a queue and include it in os_queue_list_stats() (Linux implementation).
+ */
+void os_queue_set_name(os_queue_t q, const char* name) {
+    if (!q) return;
+
+    pthread_mutex_lock(&s_named_queues_m);
+    if (!q->stats.name) { // Append on first naming only
+        struct os_queue** tail = &s_named_queues;
+        while (*tail) tail = &(*tail)->stats.next;
+        *tail = q;
+    }
+    q->stats.name = name;
+    pthread_mutex_unlock(&s_named_queues_m);
+
+    // A locked queue's mutex is reported under the queue's name
+    if (q->kind == QUEUE_LOCKED) lock_stats_set_name(&q->locked.lock, name);
+}
+
+
+/**
+ * @brief Read the statistics of a queue (Linux implementation).
+ */
+bool os_queue_get_stats(os_queue_t q, os_queue_stats_t* st) {
+    if (!q || !st) return false;
+
+    memset(st, 0, sizeof(*st));
+    st->name = q->stats.name;
+    st->capacity = q->capacity;
+
+    // Load the consumer position first so depth never goes negative
+    if (q->kind == QUEUE_SPSC) {
+        st->received = atomic_load(&q->spsc.head);
+        st->sent = atomic_load(&q->spsc.tail);
+    } else if (q->kind == QUEUE_MPMC) {
+        st->received = atomic_load(&q->mpmc.dequeue_pos);
+        st->sent = atomic_load(&q->mpmc.enqueue_pos);
+    } else if (q->kind == QUEUE_RING) {
+        // Bytes for the depth, records for the totals
+        size_t head = atomic_load(&q->ring.head);
+        st->depth = atomic_load(&q->ring.tail) - head;
+        st->received = atomic_load(&q->ring.released);
+        st->sent = atomic_load(&q->ring.committed);
+    } else {
+        pthread_mutex_lock(&q->locked.m);
+        st->received = q->locked.received;
+        st->sent = q->locked.sent;
+        pthread_mutex_unlock(&q->locked.m);
+    }
+    if (q->kind != QUEUE_RING) st->depth = (size_t)(st->sent - st->received);
+    if (st->depth > st->capacity) st->depth = st->capacity;
+    if (!RPC_QUEUE_STATS) return true;
+
+    st->high_water = atomic_load_explicit(&q->stats.high_water, memory_order_relaxed);
+    st->blocked_sends = atomic_load_explicit(&q->stats.blocked_sends, memory_order_relaxed);
+    st->blocked_send_us = atomic_load_explicit(&q->stats.blocked_ns, memory_order_relaxed) / 1000;
+    st->send_timeouts = atomic_load_explicit(&q->stats.send_timeouts, memory_order_relaxed);
+    st->recv_timeouts = atomic_load_explicit(&q->stats.recv_timeouts, memory_order_relaxed);
+    st->residence_samples = atomic_load_explicit(&q->stats.res_samples, memory_order_relaxed);
+    st->residence_us = atomic_load_explicit(&q->stats.res_ns, memory_order_relaxed) / 1000;
+    for (int b = 0; b < OS_QUEUE_HIST_BUCKETS; b++)
+        st->residence_hist[b] = atomic_load_explicit(&q->stats.res_hist[b], memory_order_relaxed);
+    return true;
+}
+
+
+/**
+ * @brief Read the statistics of every named queue (Linux implementation).
+ */
+size_t os_queue_list_stats(os_queue_stats_t* st, size_t max) {
+    size_t n = 0;
+
+    pthread_mutex_lock(&s_named_queues_m);
+    for (struct os_queue* q = s_named_queues; q; q = q->stats.next, n++) {
+        if (st && n < max) os_queue_get_stats(q, &st[n]);
+    }
+    pthread_mutex_unlock(&s_named_queues_m);
+    return n;
+}
+
+
+/* ---------- SPSC Queues ---------- */
+
+/**
+ * @brief Create a single-producer/single-consumer queue (Linux implementation).
+ *
+ * Capacity is rounded up to a power of two so slots are found with a mask.
+ */
+os_queue_t os_spsc_queue_create(size_t length, size_t item_size) {
+    if (length == 0 || item_size == 0) return NULL;
+
+    size_t cap = 1;
+    while (cap < length) cap <<= 1;
+
+    struct os_queue* q = mem_alloc(sizeof(*q));
+    if (!q) return NULL;
+
+    q->buf = mem_alloc(cap * item_size);
+    if (!q->buf) { mem_free(q); return NULL; }
+
+    q->kind = QUEUE_SPSC;
+    q->item_size = item_size;
+    q->capacity = cap;
+    if (!queue_stats_init(q)) { mem_free(q->buf); mem_free(q); return NULL; }
+    return q;
+}
+
+
+/**
+ * @brief Put the calling side to sleep until the other side wakes it.
+ *
+ * After a short spin/yield phase the parked flag is published before the
+ * queue is re-checked, and the other side checks the flag after publishing
+ * its index (Dekker-style), so either this side sees the new index or the
+ * other side sees the flag and wakes us.
+ *
+ * @param parked Park flag of the calling side.
+ * @param other Index published by the other side.
+ * @param seen Value of @p other that made us wait.
+ * @param deadline Absolute deadline, NULL to wait forever.
+ * @return false if the deadline expired.
+ */
+static bool spsc_park(atomic_uint* parked, atomic_size_t* other, size_t seen,
+                      const struct timespec* deadline) {
+    // The other side is usually mid-operation: spin, then yield, before sleeping
+    int spin = spin_count();
+    for (int i = 0; i < spin + OS_YIELD_COUNT; i++) {
+        if (atomic_load_explicit(other, memory_order_relaxed) != seen) return true;
+        if (i < spin) cpu_relax(); else sched_yield();
+    }
+
+    atomic_store(parked, 1);
+    if (atomic_load(other) != seen) {
+        atomic_store_explicit(parked, 0, memory_order_relaxed);
+        return true;
+    }
+    bool ok = futex_wait_until(parked, 1, deadline);
+    atomic_store_explicit(parked, 0, memory_order_relaxed);
+    return ok;
+}
+
+
+/**
+ * @brief Wake the other side if it is parked.
+ *
+ * Called after publishing an index; costs no syscall while nobody sleeps.
+ */
+static void spsc_unpark(atomic_uint* parked) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(parked, memory_order_relaxed) &&
+        atomic_exchange(parked, 0)) {
+        futex_wake(parked, 1);
+    }
+}
+
+
+/**
+ * @brief Producer side: wait until the slot at position @p tail is free.
+ *
+ * @return false on timeout.
+ */
+static bool spsc_wait_space(os_queue_t q, size_t tail, uint32_t timeout_ms) {
+    struct spsc_state* s = &q->spsc;
+    struct timespec ts, *deadline = NULL;
+    bool have_deadline = false;
+
+    // Only reload the consumer's head when the cached copy says "full"
+    while (tail - s->head_cache == q->capacity) {
+        s->head_cache = atomic_load_explicit(&s->head, memory_order_acquire);
+        if (tail - s->head_cache != q->capacity) break;
+
+        if (timeout_ms == 0) return false; // We are not waiting
+        if (!have_deadline) {
+            deadline = mono_deadline_ms(&ts, timeout_ms);
+            have_deadline = true;
+        }
+        if (!spsc_park(&s->producer_parked, &s->head, s->head_cache, deadline)) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Consumer side: wait until the slot at position @p head holds an item.
+ *
+ * @return false on timeout.
+ */
+static bool spsc_wait_data(os_queue_t q, size_t head, uint32_t timeout_ms) {
+    struct spsc_state* s = &q->spsc;
+    struct timespec ts, *deadline = NULL;
+    bool have_deadline = false;
+
+    // Only reload the producer's tail when the cached copy says "empty"
+    while (head == s->tail_cache) {
+        s->tail_cache = atomic_load_explicit(&s->tail, memory_order_acquire);
+        if (head != s->tail_cache) break;
+
+        if (timeout_ms == 0) return false;
+        if (!have_deadline) {
+            deadline = mono_deadline_ms(&ts, timeout_ms);
+            have_deadline = true;
+        }
+        if (!spsc_park(&s->consumer_parked, &s->tail, s->tail_cache, deadline)) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Send up to @p n items to an SPSC queue (producer side).
+ *
+ * All items are published with one index store and at most one wakeup.
+ */
+static size_t spsc_send_n(os_queue_t q, const void* items, size_t n, uint32_t timeout_ms) {
+    struct spsc_state* s = &q->spsc;
+    size_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+
+    if (!spsc_wait_space(q, tail, timeout_ms)) return 0;
+
+    // Refresh the cached head only if it does not leave room for the whole batch
+    size_t k = q->capacity - (tail - s->head_cache);
+    if (k < n) {
+        s->head_cache = atomic_load_explicit(&s->head, memory_order_acquire);
+        k = q->capacity - (tail - s->head_cache);
+    }
+    if (k > n) k = n;
+
+    ring_put(q, tail & (q->capacity - 1), items, k);
+    queue_stats_enqueue(q, tail, k);
+    atomic_store_explicit(&s->tail, tail + k, memory_order_release);
+
+    // The cached head gives an upper bound of the depth; read the real one only for a new maximum
+    if (queue_stats_above_hw(q, tail + k - s->head_cache))
+        queue_stats_depth(q, tail + k - atomic_load_explicit(&s->head, memory_order_relaxed));
+
+    spsc_unpark(&s->consumer_parked); // Signal: "data appeared!"
+    return k;
+}
+
+
+/**
+ * @brief Receive up to @p n items from an SPSC queue (consumer side).
+ *
+ * All items are released with one index store and at most one wakeup.
+ */
+static size_t spsc_recv_n(os_queue_t q, void* items, size_t n, uint32_t timeout_ms) {
+    struct spsc_state* s = &q->spsc;
+    size_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+
+    if (!spsc_wait_data(q, head, timeout_ms)) return 0;
+
+    // Refresh the cached tail only if it does not cover the whole batch
+    size_t k = s->tail_cache - head;
+    if (k < n) {
+        s->tail_cache = atomic_load_explicit(&s->tail, memory_order_acquire);
+        k = s->tail_cache - head;
+    }
+    if (k > n) k = n;
+
+    ring_get(q, head & (q->capacity - 1), items, k);
+    queue_stats_dequeue(q, head, k);
+    atomic_store_explicit(&s->head, head + k, memory_order_release);
+
+    spsc_unpark(&s->producer_parked); // Signal: "a place has appeared!"
+    return k;
+}
+
+
+/* ---------- MPMC Queues ---------- */
+
+/**
+ * @brief Create a bounded lock-free MPMC queue (Linux implementation).
+ *
+ * Capacity is rounded up to a power of two so cells are found with a mask.
+ */
+os_queue_t os_mpmc_queue_create(size_t length, size_t item_size) {
+    if (length == 0 || item_size == 0) return NULL;
+
+    size_t cap = 1;
+    while (cap < length) cap <<= 1;
+
+    // Cell: [sequence number][item], padded to keep the next sequence aligned
+    size_t stride = sizeof(atomic_size_t) + item_size;
+    stride = (stride + alignof(atomic_size_t) - 1) & ~(alignof(atomic_size_t) - 1);
+
+    struct os_queue* q = mem_alloc(sizeof(*q));
+    if (!q) return NULL;
+
+    q->buf = mem_alloc(cap * stride);
+    if (!q->buf) { mem_free(q); return NULL; }
+
+    q->kind = QUEUE_MPMC;
+    q->item_size = item_size;
+    q->capacity = cap;
+    q->mpmc.stride = stride;
+    if (!queue_stats_init(q)) { mem_free(q->buf); mem_free(q); return NULL; }
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init((atomic_size_t*)(q->buf + i * stride), i);
+    }
+    return q;
+}
+
+
+/**
+ * @brief Address of the cell serving position @p pos.
+ */
+static inline uint8_t* mpmc_cell(os_queue_t q, size_t pos) {
+    return q->buf + (pos & (q->capacity - 1)) * q->mpmc.stride;
+}
+
+
+/**
+ * @brief Try to claim up to @p n consecutive cells and copy items in; never blocks.
+ *
+ * Counts how many cells from the current position are free for this lap
+ * and claims them all with a single CAS; no other producer can take them
+ * while the position has not moved, and no consumer can touch a free cell.
+ *
+ * @return Number of items sent (0 if the queue is full).
+ */
+static size_t mpmc_try_send_n(os_queue_t q, const void* items, size_t n) {
+    struct mpmc_state* s = &q->mpmc;
+    size_t pos = atomic_load_explicit(&s->enqueue_pos, memory_order_relaxed);
+    size_t k;
+
+    for (;;) {
+        for (k = 0; k < n; k++) {
+            size_t seq = atomic_load_explicit((atomic_size_t*)mpmc_cell(q, pos + k),
+                                              memory_order_acquire);
+            if (seq != pos + k) break;
+        }
+
+        if (k > 0) {
+            if (atomic_compare_exchange_weak_explicit(&s->enqueue_pos, &pos, pos + k,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) break;
+        } else {
+            size_t seq = atomic_load_explicit((atomic_size_t*)mpmc_cell(q, pos),
+                                              memory_order_acquire);
+            if ((intptr_t)seq - (intptr_t)pos < 0)
+                return 0; // Full: cell still holds data from the previous lap
+            pos = atomic_load_explicit(&s->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    queue_stats_enqueue(q, pos, k);
+    for (size_t i = 0; i < k; i++) {
+        uint8_t* cell = mpmc_cell(q, pos + i);
+        memcpy(cell + sizeof(atomic_size_t), (const uint8_t*)items + i * q->item_size, q->item_size);
+        atomic_store_explicit((atomic_size_t*)cell, pos + i + 1, memory_order_release);
+    }
+
+    if (RPC_QUEUE_STATS) {
+        // Consumers may have claimed past our claim already: clamp at zero
+        intptr_t depth = (intptr_t)(pos + k) -
+                         (intptr_t)atomic_load_explicit(&s->dequeue_pos, memory_order_relaxed);
+        if (depth > 0) queue_stats_depth(q, (size_t)depth);
+    }
+    return k;
+}
+
+
+/**
+ * @brief Try to claim up to @p n consecutive filled cells and copy items out; never blocks.
+ *
+ * Counterpart of mpmc_try_send_n(): the run of cells already filled for
+ * this lap is claimed with a single CAS.
+ *
+ * @return Number of items received (0 if the queue is empty).
+ */
+static size_t mpmc_try_recv_n(os_queue_t q, void* items, size_t n) {
+    struct mpmc_state* s = &q->mpmc;
+    size_t pos = atomic_load_explicit(&s->dequeue_pos, memory_order_relaxed);
+    size_t k;
+
+    for (;;) {
+        for (k = 0; k < n; k++) {
+            size_t seq = atomic_load_explicit((atomic_size_t*)mpmc_cell(q, pos + k),
+                                              memory_order_acquire);
+            if (seq != pos + k + 1) break;
+        }
+
+        if (k > 0) {
+            if (atomic_compare_exchange_weak_explicit(&s->dequeue_pos, &pos, pos + k,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) break;
+        } else {
+            size_t seq = atomic_load_explicit((atomic_size_t*)mpmc_cell(q, pos),
+                                              memory_order_acquire);
+            if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+                return 0; // Empty: producer has not filled this cell yet
+            pos = atomic_load_explicit(&s->dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    queue_stats_dequeue(q, pos, k);
+    for (size_t i = 0; i < k; i++) {
+        uint8_t* cell = mpmc_cell(q, pos + i);
+        memcpy((uint8_t*)items + i * q->item_size, cell + sizeof(atomic_size_t), q->item_size);
+        atomic_store_explicit((atomic_size_t*)cell, pos + i + q->capacity, memory_order_release);
+    }
+    return k;
+}
+
+
+/**
+ * @brief Wake up to @p n parked threads, if any are registered on the event count.
+ */
+static void eventcount_notify(struct eventcount* ec, size_t n) {
+    atomic_thread_fence(memory_order_seq_cst);
+    unsigned waiters = atomic_load_explicit(&ec->waiters, memory_order_relaxed);
+    if (waiters) {
+        atomic_fetch_add(&ec->epoch, 1);
+        futex_wake(&ec->epoch, (n < waiters) ? (int)n : (int)waiters);
+    }
+}
+
+
+/**
+ * @brief Run a non-blocking batch operation, parking on @p ec until it moves an item.
+ *
+ * @param q Queue handle.
+ * @param items Items to send or buffer to receive into.
+ * @param n Maximum number of items.
+ * @param op mpmc_try_send_n or mpmc_try_recv_n.
+ * @param ec Event count notified when @p op may succeed.
+ * @param timeout_ms Timeout in milliseconds (OS_WAIT_FOREVER for blocking).
+ * @return Number of items moved, 0 on timeout.
+ */
+static size_t mpmc_wait(os_queue_t q, void* items, size_t n,
+                        size_t (*op)(os_queue_t, void*, size_t),
+                        struct eventcount* ec, uint32_t timeout_ms) {
+    size_t k = op(q, items, n);
+    if (k || timeout_ms == 0) return k;
+
+    int spin = spin_count();
+    for (int i = 0; i < spin + OS_YIELD_COUNT; i++) {
+        if (i < spin) cpu_relax(); else sched_yield();
+        if ((k = op(q, items, n))) return k;
+    }
+
+    struct timespec ts;
+    const struct timespec* deadline = mono_deadline_ms(&ts, timeout_ms);
+
+    for (;;) {
+        atomic_fetch_add(&ec->waiters, 1);
+        unsigned epoch = atomic_load(&ec->epoch);
+        if ((k = op(q, items, n))) {
+            atomic_fetch_sub(&ec->waiters, 1);
+            return k;
+        }
+        bool ok = futex_wait_until(&ec->epoch, epoch, deadline);
+        atomic_fetch_sub(&ec->waiters, 1);
+        if ((k = op(q, items, n))) return k;
+        if (!ok) return 0;
+    }
+}
+
+
+/**
+ * @brief Adapter giving mpmc_try_send_n the signature expected by mpmc_wait.
+ */
+static size_t mpmc_try_send_op(os_queue_t q, void* items, size_t n) {
+    return mpmc_try_send_n(q, items, n);
+}
+
+
+/**
+ * @brief Send up to @p n items to an MPMC queue.
+ */
+static size_t mpmc_send_n(os_queue_t q, const void* items, size_t n, uint32_t timeout_ms) {
+    size_t k = mpmc_wait(q, (void*)items, n, mpmc_try_send_op, &q->mpmc.not_full, timeout_ms);
+    if (k) eventcount_notify(&q->mpmc.not_empty, k); // Signal: "data appeared!"
+    return k;
+}
+
+
+/**
+ * @brief Receive up to @p n items from an MPMC queue.
+ */
+static size_t mpmc_recv_n(os_queue_t q, void* items, size_t n, uint32_t timeout_ms) {
+    size_t k = mpmc_wait(q, items, n, mpmc_try_recv_n, &q->mpmc.not_empty, timeout_ms);
+    if (k) eventcount_notify(&q->mpmc.not_full, k); // Signal: "a place has appeared!"
+    return k;
+}
+
+
+/* ---------- In-Place Queue Access ---------- */
+
+/**
+ * @brief Reserve the tail slot of a locked queue; returns with the lock held.
+ */
+static void* locked_reserve(os_queue_t q, uint32_t timeout_ms) {
+    struct timespec ts;
+    const struct timespec* deadline = (timeout_ms != 0) ? mono_deadline_ms(&ts, timeout_ms) : NULL;
+
+    lock_take(&q->locked.m, &q->locked.lock);
+    while (q->locked.count == q->capacity) {
+        if (timeout_ms == 0) { lock_drop(&q->locked.m, &q->locked.lock); return NULL; }
+        if (!lock_wait(&q->locked.not_full, &q->locked.m, &q->locked.lock, deadline)) { lock_drop(&q->locked.m, &q->locked.lock); return NULL; }
+    }
+    return q->buf + q->locked.tail * q->item_size;
+}
+
+
+/**
+ * @brief Publish the reserved tail slot of a locked queue and drop the lock.
+ */
+static void locked_commit(os_queue_t q) {
+    queue_stats_enqueue(q, q->locked.sent, 1);
+    q->locked.tail = (q->locked.tail + 1) % q->capacity;
+    q->locked.count++;
+    q->locked.sent++;
+    queue_stats_depth(q, q->locked.count);
+    pthread_cond_signal(&q->locked.not_empty);
+    lock_drop(&q->locked.m, &q->locked.lock);
+}
+
+
+/**
+ * @brief Expose the head item of a locked queue; returns with the lock held.
+ */
+static const void* locked_peek(os_queue_t q, uint32_t timeout_ms) {
+    struct timespec ts;
+    const struct timespec* deadline = (timeout_ms != 0) ? mono_deadline_ms(&ts, timeout_ms) : NULL;
+
+    lock_take(&q->locked.m, &q->locked.lock);
+    while (q->locked.count == 0) {
+        if (timeout_ms == 0) { lock_drop(&q->locked.m, &q->locked.lock); return NULL; }
+        if (!lock_wait(&q->locked.not_empty, &q->locked.m, &q->locked.lock, deadline)) { lock_drop(&q->locked.m, &q->locked.lock); return NULL; }
+    }
+    return q->buf + q->locked.head * q->item_size;
+}
+
+
+/**
+ * @brief Free the peeked head slot of a locked queue and drop the lock.
+ */
+static void locked_release(os_queue_t q) {
+    queue_stats_dequeue(q, q->locked.received, 1);
+    q->locked.head = (q->locked.head + 1) % q->capacity;
+    q->locked.count--;
+    q->locked.received++;
+    pthread_cond_signal(&q->locked.not_full);
+    lock_drop(&q->locked.m, &q->locked.lock);
+}
+
+
+/**
+ * @brief Reserve the tail slot of an SPSC queue (producer side).
+ */
+static void* spsc_reserve(os_queue_t q, uint32_t timeout_ms) {
+    size_t tail = atomic_load_explicit(&q->spsc.tail, memory_order_relaxed);
+    if (!spsc_wait_space(q, tail, timeout_ms)) return NULL;
+    return q->buf + (tail & (q->capacity - 1)) * q->item_size;
+}
+
+
+/**
+ * @brief Publish the reserved tail slot of an SPSC queue.
+ */
+static void spsc_commit(os_queue_t q) {
+    struct spsc_state* s = &q->spsc;
+    size_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+
+    queue_stats_enqueue(q, tail, 1);
+    atomic_store_explicit(&s->tail, tail + 1, memory_order_release);
+    if (queue_stats_above_hw(q, tail + 1 - s->head_cache))
+        queue_stats_depth(q, tail + 1 - atomic_load_explicit(&s->head, memory_order_relaxed));
+
+    spsc_unpark(&s->consumer_parked); // Signal: "data appeared!"
+}
+
+
+/**
+ * @brief Expose the head item of an SPSC queue (consumer side).
+ */
+static const void* spsc_peek(os_queue_t q, uint32_t timeout_ms) {
+    size_t head = atomic_load_explicit(&q->spsc.head, memory_order_relaxed);
+    if (!spsc_wait_data(q, head, timeout_ms)) return NULL;
+    return q->buf + (head & (q->capacity - 1)) * q->item_size;
+}
+
+
+/**
+ * @brief Free the peeked head slot of an SPSC queue.
+ */
+static void spsc_release(os_queue_t q) {
+    struct spsc_state* s = &q->spsc;
+    size_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+
+    queue_stats_dequeue(q, head, 1);
+    atomic_store_explicit(&s->head, head + 1, memory_order_release);
+    spsc_unpark(&s->producer_parked); // Signal: "a place has appeared!"
+}
+
+
+/**
+ * @brief Try to claim one free MPMC cell; never blocks (mpmc_wait() operation).
+ *
+ * @param slot Receives the item address inside the claimed cell (void**).
+ * @return 1 if a cell was claimed, 0 if the queue is full.
+ */
+static size_t mpmc_try_reserve(os_queue_t q, void* slot, size_t n) {
+    struct mpmc_state* s = &q->mpmc;
+    size_t pos = atomic_load_explicit(&s->enqueue_pos, memory_order_relaxed);
+    (void)n;
+
+    for (;;) {
+        uint8_t* cell = mpmc_cell(q, pos);
+        size_t seq = atomic_load_explicit((atomic_size_t*)cell, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *(void**)slot = cell + sizeof(atomic_size_t);
+                return 1;
+            }
+        } else if (dif < 0) {
+            return 0; // Full
+        } else {
+            pos = atomic_load_explicit(&s->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+
+/**
+ * @brief Try to claim one filled MPMC cell; never blocks (mpmc_wait() operation).
+ *
+ * @param slot Receives the item address inside the claimed cell (void**).
+ * @return 1 if a cell was claimed, 0 if the queue is empty.
+ */
+static size_t mpmc_try_peek(os_queue_t q, void* slot, size_t n) {
+    struct mpmc_state* s = &q->mpmc;
+    size_t pos = atomic_load_explicit(&s->dequeue_pos, memory_order_relaxed);
+    (void)n;
+
+    for (;;) {
+        uint8_t* cell = mpmc_cell(q, pos);
+        size_t seq = atomic_load_explicit((atomic_size_t*)cell, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *(void**)slot = cell + sizeof(atomic_size_t);
+                return 1;
+            }
+        } else if (dif < 0) {
+            return 0; // Empty
+        } else {
+            pos = atomic_load_explicit(&s->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+
+/**
+ * @brief Publish a claimed MPMC cell.
+ *
+ * The cell's sequence number still equals the claimed position, so
+ * commits may happen in any order.
+ */
+static void mpmc_commit(os_queue_t q, void* slot) {
+    atomic_size_t* seq = (atomic_size_t*)((uint8_t*)slot - sizeof(atomic_size_t));
+    size_t pos = atomic_load_explicit(seq, memory_order_relaxed);
+
+    queue_stats_enqueue(q, pos, 1);
+    atomic_store_explicit(seq, pos + 1, memory_order_release);
+
+    if (RPC_QUEUE_STATS) {
+        intptr_t depth = (intptr_t)(pos + 1) -
+                         (intptr_t)atomic_load_explicit(&q->mpmc.dequeue_pos, memory_order_relaxed);
+        if (depth > 0) queue_stats_depth(q, (size_t)depth);
+    }
+    eventcount_notify(&q->mpmc.not_empty, 1); // Signal: "data appeared!"
+}
+
+
+/**
+ * @brief Free a claimed MPMC cell for the next lap.
+ */
+static void mpmc_release(os_queue_t q, const void* slot) {
+    atomic_size_t* seq = (atomic_size_t*)((uint8_t*)slot - sizeof(atomic_size_t));
+    size_t pos = atomic_load_explicit(seq, memory_order_relaxed) - 1;
+
+    queue_stats_dequeue(q, pos, 1);
+    atomic_store_explicit(seq, pos + q->capacity, memory_order_release);
+    eventcount_notify(&q->mpmc.not_full, 1); // Signal: "a place has appeared!"
+}
+
+
+/**
+ * @brief Reserve a slot with the queue flavour's own method.
+ */
+static void* queue_reserve(os_queue_t q, uint32_t timeout_ms) {
+    void* slot = NULL;
+
+    if (q->kind == QUEUE_SPSC) return spsc_reserve(q, timeout_ms);
+    if (q->kind == QUEUE_MPMC) {
+        mpmc_wait(q, &slot, 1, mpmc_try_reserve, &q->mpmc.not_full, timeout_ms);
+        return slot;
+    }
+    return locked_reserve(q, timeout_ms);
+}
+
+
+/**
+ * @brief Reserve a slot for in-place writing (Linux implementation).
+ *
+ * Counted like os_queue_send_n(): only reservations that really wait are
+ * recorded as blocked.
+ */
+void* os_queue_reserve(os_queue_t q, uint32_t timeout_ms) {
+    if (!q || q->kind == QUEUE_RING) return NULL;
+    if (!RPC_QUEUE_STATS) return queue_reserve(q, timeout_ms);
+
+    void* slot = queue_reserve(q, OS_NO_WAIT);
+    if (slot) return slot;
+
+    if (timeout_ms != OS_NO_WAIT) {
+        uint64_t t0 = mono_ns();
+        slot = queue_reserve(q, timeout_ms);
+        atomic_fetch_add_explicit(&q->stats.blocked_sends, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&q->stats.blocked_ns, mono_ns() - t0, memory_order_relaxed);
+    }
+    if (!slot) atomic_fetch_add_explicit(&q->stats.send_timeouts, 1, memory_order_relaxed);
+    return slot;
+}
+
+
+/**
+ * @brief Publish a reserved slot (Linux implementation).
+ */
+void os_queue_commit(os_queue_t q, void* slot) {
+    if (!q || !slot) return;
+
+    if (q->kind == QUEUE_SPSC) spsc_commit(q);
+    else if (q->kind == QUEUE_MPMC) mpmc_commit(q, slot);
+    else locked_commit(q);
+}
+
+
+/**
+ * @brief Access the oldest item in place (Linux implementation).
+ */
+const void* os_queue_peek(os_queue_t q, uint32_t timeout_ms) {
+    if (!q || q->kind == QUEUE_RING) return NULL;
+
+    void* slot = NULL;
+    if (q->kind == QUEUE_SPSC) slot = (void*)spsc_peek(q, timeout_ms);
+    else if (q->kind == QUEUE_MPMC) mpmc_wait(q, &slot, 1, mpmc_try_peek, &q->mpmc.not_empty, timeout_ms);
+    else slot = (void*)locked_peek(q, timeout_ms);
+
+    if (RPC_QUEUE_STATS && !slot && timeout_ms != OS_NO_WAIT)
+        atomic_fetch_add_explicit(&q->stats.recv_timeouts, 1, memory_order_relaxed);
+    return slot;
+}
+
+
+/**
+ * @brief Free a peeked slot (Linux implementation).
+ */
+void os_queue_release(os_queue_t q, const void* slot) {
+    if (!q || !slot) return;
+
+    if (q->kind == QUEUE_SPSC) spsc_release(q);
+    else if (q->kind == QUEUE_MPMC) mpmc_release(q, slot);
+    else locked_release(q);
+}
+
+
+/* ---------- Byte Rings ---------- */
+
+/**
+ * @brief Record header, in front of every record's data.
+ *
+ * Records never wrap: a producer whose record does not fit before the end
+ * of the buffer also claims the rest of the lap, marked by a padding
+ * header (or left unmarked when shorter than a header; both sides skip
+ * such tails).
+ */
+struct ring_hdr {
+    atomic_uint ready;   /**< Set by the commit, reset by the consumer's zeroing */
+    uint32_t len;        /**< Data length, RING_PAD for padding or a discarded record */
+    uint32_t span;       /**< Bytes taken, header and alignment included */
+    uint32_t cap;        /**< Reserved data length */
+    uint64_t stamp;      /**< Commit time (ns) of a sampled record, 0 otherwise */
+};
+
+#define RING_ALIGN 8                        /**< Record alignment */
+#define RING_HDR   sizeof(struct ring_hdr)  /**< Header size, a multiple of RING_ALIGN */
+#define RING_PAD   UINT32_MAX               /**< Length of records the consumer skips */
+
+
+/**
+ * @brief Consumer-side view of a record (ring_try_peek() output).
+ */
+struct ring_view {
+    const void* data; /**< Record data */
+    size_t len;       /**< Record length */
+};
+
+
+/**
+ * @brief Bytes a record of @p len data bytes takes.
+ */
+static inline size_t ring_span(size_t len) {
+    return (RING_HDR + len + RING_ALIGN - 1) & ~(size_t)(RING_ALIGN - 1);
+}
+
+
+/**
+ * @brief Header of the record at position @p pos.
+ */
+static inline struct ring_hdr* ring_hdr_at(os_queue_t q, size_t pos) {
+    return (struct ring_hdr*)(q->buf + (pos & (q->capacity - 1)));
+}
+
+
+/**
+ * @brief Create a byte ring (Linux implementation).
+ *
+ * Size is rounded up to a power of two so positions are mapped with a mask.
+ */
+os_queue_t os_ring_create(size_t bytes) {
+    if (bytes < 2 * ring_span(1)) return NULL;
+
+    size_t cap = 1;
+    while (cap < bytes) cap <<= 1;
+
+    struct os_queue* q = mem_alloc(sizeof(*q));
+    if (!q) return NULL;
+
+    q->buf = mem_alloc(cap); // Zeroed: no header reads as ready
+    if (!q->buf) { mem_free(q); return NULL; }
+
+    q->kind = QUEUE_RING;
+    q->capacity = cap;
+    return q;
+}
+
+
+/**
+ * @brief Try to claim space for a record of @p len bytes; never blocks (mpmc_wait() operation).
+ *
+ * @param rec Receives the record data address (void**).
+ * @return 1 if claimed, 0 if the ring is full.
+ */
+static size_t ring_try_reserve(os_queue_t q, void* rec, size_t len) {
+    struct ring_state* s = &q->ring;
+    size_t need = ring_span(len);
+    size_t pos = atomic_load_explicit(&s->tail, memory_order_relaxed);
+
+    for (;;) {
+        size_t room = q->capacity - (pos & (q->capacity - 1));
+        size_t skip = (room < need) ? room : 0;
+        size_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+
+        if (pos + skip + need - head > q->capacity) return 0; // Full
+        if (atomic_compare_exchange_weak_explicit(&s->tail, &pos, pos + skip + need,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) break;
+    }
+
+    size_t room = q->capacity - (pos & (q->capacity - 1));
+    if (room < need) {
+        if (room >= RING_HDR) {
+            struct ring_hdr* pad = ring_hdr_at(q, pos);
+            pad->len = RING_PAD;
+            pad->span = (uint32_t)room;
+            atomic_store_explicit(&pad->ready, 1, memory_order_release);
+        }
+        pos += room;
+    }
+
+    struct ring_hdr* h = ring_hdr_at(q, pos);
+    h->span = (uint32_t)need;
+    h->cap = (uint32_t)len;
+    *(void**)rec = h + 1;
+    return 1;
+}
+
+
+/**
+ * @brief Try to find the oldest committed record; never blocks (mpmc_wait() operation).
+ *
+ * Padding on the way is consumed.
+ *
+ * @param view Receives the record (struct ring_view*).
+ * @return 1 if a record is ready, 0 otherwise.
+ */
+static size_t ring_try_peek(os_queue_t q, void* view, size_t n) {
+    struct ring_state* s = &q->ring;
+    size_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    (void)n;
+
+    for (;;) {
+        size_t room = q->capacity - (head & (q->capacity - 1));
+        if (room < RING_HDR) {
+            // Tail too short for a header: producers skipped it as well
+            if (atomic_load_explicit(&s->tail, memory_order_acquire) == head) return 0;
+            head += room;
+            atomic_store_explicit(&s->head, head, memory_order_release);
+            continue;
+        }
+
+        struct ring_hdr* h = ring_hdr_at(q, head);
+        if (!atomic_load_explicit(&h->ready, memory_order_acquire)) return 0;
+
+        if (h->len == RING_PAD) {
+            size_t span = h->span;
+            memset(h, 0, span);
+            head += span;
+            atomic_store_explicit(&s->head, head, memory_order_release);
+            eventcount_notify(&s->not_full, 1);
+            continue;
+        }
+
+        struct ring_view* v = view;
+        v->data = h + 1;
+        v->len = h->len;
+        return 1;
+    }
+}
+
+
+/**
+ * @brief Reserve a record (Linux implementation).
+ *
+ * Counted like os_queue_send_n(): only reservations that really wait are
+ * recorded as blocked.
+ */
+void* os_ring_reserve(os_queue_t q, size_t len, uint32_t timeout_ms) {
+    void* rec = NULL;
+
+    if (!q || q->kind != QUEUE_RING || 2 * ring_span(len) > q->capacity) return NULL;
+
+    if (ring_try_reserve(q, &rec, len)) return rec;
+
+    if (timeout_ms != OS_NO_WAIT) {
+        uint64_t t0 = RPC_QUEUE_STATS ? mono_ns() : 0;
+        mpmc_wait(q, &rec, len, ring_try_reserve, &q->ring.not_full, timeout_ms);
+        if (RPC_QUEUE_STATS) {
+            atomic_fetch_add_explicit(&q->stats.blocked_sends, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&q->stats.blocked_ns, mono_ns() - t0, memory_order_relaxed);
+        }
+    }
+    if (RPC_QUEUE_STATS && !rec)
+        atomic_fetch_add_explicit(&q->stats.send_timeouts, 1, memory_order_relaxed);
+    return rec;
+}
+
+
+/**
+ * @brief Publish a reserved record (Linux implementation).
+ */
+void os_ring_commit(os_queue_t q, void* rec, size_t len) {
+    if (!q || !rec) return;
+
+    struct ring_hdr* h = (struct ring_hdr*)rec - 1;
+    h->len = (len && len <= h->cap) ? (uint32_t)len : RING_PAD;
+    h->stamp = 0;
+
+    if (h->len != RING_PAD) {
+        uint64_t n = atomic_fetch_add_explicit(&q->ring.committed, 1, memory_order_relaxed);
+        if (RPC_QUEUE_STATS && n % RPC_QUEUE_STATS_SAMPLE == 0) h->stamp = mono_ns();
+    }
+    atomic_store_explicit(&h->ready, 1, memory_order_release);
+
+    if (RPC_QUEUE_STATS) {
+        queue_stats_depth(q, atomic_load_explicit(&q->ring.tail, memory_order_relaxed) -
+                             atomic_load_explicit(&q->ring.head, memory_order_relaxed));
+    }
+    eventcount_notify(&q->ring.not_empty, 1); // Signal: "data appeared!"
+}
+
+
+/**
+ * @brief Access the oldest record in place (Linux implementation).
+ */
+const void* os_ring_peek(os_queue_t q, size_t* len, uint32_t timeout_ms) {
+    struct ring_view v = { NULL, 0 };
+
+    if (!q || q->kind != QUEUE_RING) return NULL;
+
+    mpmc_wait(q, &v, 1, ring_try_peek, &q->ring.not_empty, timeout_ms);
+    if (RPC_QUEUE_STATS && !v.data && timeout_ms != OS_NO_WAIT)
+        atomic_fetch_add_explicit(&q->stats.recv_timeouts, 1, memory_order_relaxed);
+    if (len) *len = v.len;
+    return v.data;
+}
+
+
+/**
+ * @brief Free a peeked record (Linux implementation).
+ *
+ * The record's bytes are zeroed before the space is handed back, so the
+ * next header placed there is not ready until committed.
+ */
+void os_ring_release(os_queue_t q, const void* rec) {
+    if (!q || !rec) return;
+
+    struct ring_hdr* h = (struct ring_hdr*)rec - 1;
+    size_t span = h->span;
+
+    if (RPC_QUEUE_STATS && h->stamp) queue_stats_residence(q, mono_ns() - h->stamp);
+    memset(h, 0, span);
+    atomic_fetch_add_explicit(&q->ring.released, 1, memory_order_relaxed);
+    atomic_store_explicit(&q->ring.head,
+                          atomic_load_explicit(&q->ring.head, memory_order_relaxed) + span,
+                          memory_order_release);
+    eventcount_notify(&q->ring.not_full, 1); // Signal: "a place has appeared!"
+}
+
+
+/* ---------- Binary Semaphores ---------- */
+
+/** Semaphore states held in the futex word */
+enum {
+    SEM_TAKEN   = 0, /**< Not available, nobody sleeping */
+    SEM_FREE    = 1, /**< Available */
+    SEM_WAITERS = 2  /**< Not available, threads may be sleeping */
+};
+
+
+/**
+ * @brief Binary semaphore structure for Linux implementation.
+ *
+ * A single futex word: give and take are one atomic operation each while
+ * nobody waits, and the kernel is only entered to sleep or to wake a sleeper.
+ */
+struct os_sem {
+    atomic_uint v; /**< SEM_TAKEN, SEM_FREE or SEM_WAITERS */
+};
+
+
+/**
+ * @brief Create a binary semaphore (Linux implementation).
+ */
+os_sem_t os_sem_create_binary(void) {
+    struct os_sem* s = mem_alloc(sizeof(*s));
+    if (!s) return NULL;
+    atomic_init(&s->v, SEM_TAKEN);
+    return s;
+}
+
+
+/**
+ * @brief Take a binary semaphore (Linux implementation).
+ */
+bool os_sem_take(os_sem_t s, uint32_t timeout_ms) {
+    // Fast path: available and uncontended
+    unsigned c = SEM_FREE;
+    if (atomic_compare_exchange_strong(&s->v, &c, SEM_TAKEN)) return true;
+    if (timeout_ms == 0) return false; // Non-blocking mode
+
+    struct timespec ts;
+    const struct timespec* deadline = mono_deadline_ms(&ts, timeout_ms);
+
+    // Slow path: announce a sleeper; taking it this way keeps the flag set
+    // so the next give still wakes whoever else may be sleeping
+    for (;;) {
+        if (atomic_exchange(&s->v, SEM_WAITERS) == SEM_FREE) return true;
+        if (!futex_wait_until(&s->v, SEM_WAITERS, deadline)) return false; // Wait with timeout
+    }
+}
+
+
+/**
+ * @brief Take a binary semaphore after a bounded busy-poll (Linux implementation).
+ *
+ * The clock is read once per OS_SPIN_CHECK polls.
+ */
+bool os_sem_take_spin(os_sem_t s, uint32_t spin_ns, uint32_t timeout_ms) {
+    if (spin_ns && timeout_ms != 0) {
+        bool yield = (spin_count() == 0); // Single CPU: the giver needs it
+        uint64_t end = mono_ns() + spin_ns;
+        do {
+            for (int i = 0; i < OS_SPIN_CHECK; i++) {
+                unsigned c = SEM_FREE;
+                if (atomic_load_explicit(&s->v, memory_order_relaxed) == SEM_FREE &&
+                    atomic_compare_exchange_strong(&s->v, &c, SEM_TAKEN)) return true;
+                if (yield) sched_yield(); else cpu_relax();
+            }
+        } while (mono_ns() < end);
+    }
+    return os_sem_take(s, timeout_ms);
+}
+
+
+/**
+ * @brief Give a binary semaphore (Linux implementation).
+ */
+void os_sem_give(os_sem_t s) {
+    // Only enter the kernel if somebody announced it is sleeping
+    if (atomic_exchange(&s->v, SEM_FREE) == SEM_WAITERS) {
+        futex_wake(&s->v, 1);
+    }
+}
+
+
+/* ---------- Mutex ---------- */
+
+/** Mutex structure for Linux implementation */
+struct os_mutex {
+	pthread_mutex_t m;
+	struct lock_stats lock; /**< Contention statistics (RPC_MUTEX_STATS) */
+};
+
+
+/**
+ * @brief Create a mutex (Linux implementation).
+ */
+os_mutex_t os_mutex_create(void) {
+    os_mutex_t mu = mem_alloc(sizeof(*mu));
+    if (!mu) return NULL;
+    pthread_mutex_init(&mu->m, NULL);
+    return mu;
+}
+
+
+/**
+ * @brief Create a priority-inheritance mutex (Linux implementation).
+ */
+os_mutex_t os_mutex_create_pi(void) {
+    os_mutex_t mu = mem_alloc(sizeof(*mu));
+    if (!mu) return NULL;
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    if (pthread_mutex_init(&mu->m, &attr) != 0) {
+        pthread_mutex_init(&mu->m, NULL); // PI not supported: plain mutex
+    }
+    pthread_mutexattr_destroy(&attr);
+    return mu;
+}
+
+
+/**
+ * @brief Lock a mutex (Linux implementation).
+ */
+void os_mutex_lock(os_mutex_t m)   { lock_take(&m->m, &m->lock); }
+
+
+/**
+ * @brief Unlock a mutex (Linux implementation).
+ */
+void os_mutex_unlock(os_mutex_t m) { lock_drop(&m->m, &m->lock); }
+
+
+/**
+ * @brief Name a mutex and include it in os_mutex_list_stats() (Linux implementation).
+ */
+void os_mutex_set_name(os_mutex_t m, const char* name) {
+    if (m && name) lock_stats_set_name(&m->lock, name);
+}
+
+
+/**
+ * @brief Read the contention statistics of a mutex (Linux implementation).
+ */
+bool os_mutex_get_stats(os_mutex_t m, os_mutex_stats_t* st) {
+    if (!m || !st) return false;
+    lock_stats_get(&m->lock, st);
+    return true;
+}
+
+
+/**
+ * @brief Read the contention statistics of every named lock (Linux implementation).
+ */
+size_t os_mutex_list_stats(os_mutex_stats_t* st, size_t max) {
+    size_t n = 0;
+
+    pthread_mutex_lock(&s_named_locks_m);
+    for (const struct lock_stats* s = s_named_locks; s; s = s->next, n++) {
+        if (st && n < max) lock_stats_get(s, &st[n]);
+    }
+    pthread_mutex_unlock(&s_named_locks_m);
+    return n;
+}
+
+
+/* ---------- Event Polling ---------- */
+
+/** Poller structure for Linux implementation */
+struct os_poller {
+    int epfd; /**< epoll instance */
+};
+
+
+/**
+ * @brief Create a poller (Linux implementation, epoll).
+ */
+os_poller_t os_poller_create(void) {
+    struct os_poller* p = mem_alloc(sizeof(*p));
+    if (!p) return NULL;
+
+    p->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (p->epfd < 0) { mem_free(p); return NULL; }
+    return p;
+}
+
+
+/**
+ * @brief Watch a descriptor for readability (Linux implementation).
+ */
+bool os_poller_add(os_poller_t p, int fd, void* ctx) {
+    if (!p || fd < 0) return false;
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = ctx };
+    return epoll_ctl(p->epfd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+
+/**
+ * @brief Wait for readable descriptors (Linux implementation).
+ */
+int os_poller_wait(os_poller_t p, void** ready, int max, uint32_t timeout_ms) {
+    if (!p || !ready || max <= 0) return -1;
+
+    struct epoll_event ev[16];
+    if (max > (int)(sizeof(ev) / sizeof(ev[0]))) max = (int)(sizeof(ev) / sizeof(ev[0]));
+
+    int timeout = (timeout_ms == OS_WAIT_FOREVER) ? -1
+                : (timeout_ms > INT_MAX) ? INT_MAX : (int)timeout_ms;
+    int n = epoll_wait(p->epfd, ev, max, timeout);
+    if (n < 0) return (errno == EINTR) ? 0 : -1;
+
+    for (int i = 0; i < n; i++) ready[i] = ev[i].data.ptr;
+    return n;
+}
+
+
+/* ---------- Pollable Timers ---------- */
+
+/** Timer structure for Linux implementation */
+struct os_timer {
+    int tfd; /**< timerfd on CLOCK_MONOTONIC */
+};
+
+
+/**
+ * @brief Create a one-shot pollable timer (Linux implementation, timerfd).
+ */
+os_timer_t os_timer_create(void) {
+    struct os_timer* t = mem_alloc(sizeof(*t));
+    if (!t) return NULL;
+
+    t->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (t->tfd < 0) { mem_free(t); return NULL; }
+    return t;
+}
+
+
+/**
+ * @brief Descriptor of a pollable timer (Linux implementation).
+ */
+int os_timer_fd(os_timer_t t) {
+    return t ? t->tfd : -1;
+}
+
+
+/**
+ * @brief Arm a pollable timer for an absolute deadline (Linux implementation).
+ *
+ * os_time_ms() reads CLOCK_MONOTONIC as well, so the deadline is used as is.
+ */
+void os_timer_arm(os_timer_t t, uint64_t deadline_ms) {
+    if (!t) return;
+
+    struct itimerspec its = {0};
+    its.it_value.tv_sec  = (time_t)(deadline_ms / 1000);
+    its.it_value.tv_nsec = (long)(deadline_ms % 1000) * 1000000L;
+    // An all-zero it_value would disarm: keep past deadlines firing
+    if (deadline_ms && !its.it_value.tv_sec && !its.it_value.tv_nsec) its.it_value.tv_nsec = 1;
+    timerfd_settime(t->tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+
+/**
+ * @brief Acknowledge a pollable timer expiration (Linux implementation).
+ */
+void os_timer_ack(os_timer_t t) {
+    if (!t) return;
+
+    uint64_t expirations;
+    ssize_t r = read(t->tfd, &expirations, sizeof(expirations)); // EAGAIN if re-armed meanwhile
+    (void)r;
+}
+
+
+/* ---------- Pollable Events ---------- */
+
+/** Event structure for Linux implementation */
+struct os_event {
+    int efd; /**< eventfd */
+};
+
+
+/**
+ * @brief Create a pollable event (Linux implementation, eventfd).
+ */
+os_event_t os_event_create(void) {
+    struct os_event* e = mem_alloc(sizeof(*e));
+    if (!e) return NULL;
+
+    e->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (e->efd < 0) { mem_free(e); return NULL; }
+    return e;
+}
+
+
+/**
+ * @brief Descriptor of a pollable event (Linux implementation).
+ */
+int os_event_fd(os_event_t e) {
+    return e ? e->efd : -1;
+}
+
+
+/**
+ * @brief Signal a pollable event (Linux implementation).
+ */
+void os_event_signal(os_event_t e) {
+    if (!e) return;
+
+    uint64_t one = 1;
+    ssize_t r = write(e->efd, &one, sizeof(one)); // EAGAIN only at counter overflow
+    (void)r;
+}
+
+
+/**
+ * @brief Reset a pollable event (Linux implementation).
+ */
+void os_event_clear(os_event_t e) {
+    if (!e) return;
+
+    uint64_t count;
+    ssize_t r = read(e->efd, &count, sizeof(count)); // EAGAIN if not signalled
+    (void)r;
+}
+
+
+/* ---------- Timer Wheel ---------- */
+
+/** Slots per wheel level (log2) */
+#define TW_BITS   6
+#define TW_SLOTS  (1u << TW_BITS)
+#define TW_MASK   (TW_SLOTS - 1)
+
+/** Wheel levels: 4 x 6 bits cover 2^24 ticks (4.6 hours at 1 ms); later timers are re-cascaded */
+#define TW_LEVELS 4
+#define TW_RANGE  (1ULL << (TW_BITS * TW_LEVELS))
+
+/** os_wtimer_t::level of a due timer waiting on the expired list */
+#define TW_EXPIRED 0xFF
+
+
+/**
+ * @brief Hierarchical timer wheel (Linux implementation).
+ *
+ * Level L holds timers due within 64^(L+1) ticks, in slots of 64^L ticks.
+ * When the level-0 index wraps, the due slot of the level above is
+ * re-inserted ("cascaded") into the finer levels. A bitmap per level finds
+ * the next occupied slot with one instruction, so idle stretches are
+ * skipped and the timerfd is only armed for ticks that have work.
+ */
+struct os_twheel {
+    pthread_mutex_t m;                          /**< Protects everything below */
+    struct lock_stats lock;                     /**< Contention statistics of @c m (RPC_MUTEX_STATS) */
+    pthread_cond_t idle;                        /**< Signalled when a callback returns */
+    uint32_t tick_ms;                           /**< Resolution */
+    uint64_t tick;                              /**< Next tick to process */
+    size_t count;                               /**< Timers in the wheel */
+    uint64_t occupied[TW_LEVELS];               /**< Non-empty slot bitmap per level */
+    os_wtimer_t* slot[TW_LEVELS][TW_SLOTS];     /**< Timer lists */
+    os_wtimer_t* expired;                       /**< Due timers waiting for their callback */
+    os_wtimer_t* running;                       /**< Timer whose callback runs now */
+    pthread_t runner;                           /**< Thread running that callback */
+    uint64_t armed;                             /**< Tick the timerfd is armed for, 0 if none */
+    os_timer_t timer;                           /**< timerfd driving the wheel */
+};
+
+
+/**
+ * @brief Push a timer onto a list.
+ */
+static void twheel_link(os_wtimer_t** head, os_wtimer_t* t) {
+    t->next = *head;
+    if (t->next) t->next->pprev = &t->next;
+    t->pprev = head;
+    *head = t;
+}
+
+
+/**
+ * @brief Remove a timer from whatever list holds it.
+ */
+static void twheel_unlink(os_wtimer_t* t) {
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->next = NULL;
+    t->pprev = NULL;
+}
+
+
+/**
+ * @brief Place a timer in the slot matching its expiry, relative to the current tick.
+ */
+static void twheel_insert(os_twheel_t w, os_wtimer_t* t) {
+    uint64_t e = (t->expires < w->tick) ? w->tick : t->expires;
+    uint64_t delta = e - w->tick;
+    if (delta >= TW_RANGE) e = w->tick + TW_RANGE - 1; // Re-cascaded until really due
+
+    unsigned level = 0;
+    while (level < TW_LEVELS - 1 && delta >= (1ULL << (TW_BITS * (level + 1)))) level++;
+    unsigned idx = (unsigned)(e >> (TW_BITS * level)) & TW_MASK;
+
+    t->level = (uint8_t)level;
+    t->slot = (uint8_t)idx;
+    twheel_link(&w->slot[level][idx], t);
+    w->occupied[level] |= 1ULL << idx;
+}
+
+
+/**
+ * @brief Take a timer out of its wheel slot.
+ */
+static void twheel_remove(os_twheel_t w, os_wtimer_t* t) {
+    twheel_unlink(t);
+    if (!w->slot[t->level][t->slot]) w->occupied[t->level] &= ~(1ULL << t->slot);
+    w->count--;
+}
+
+
+/**
+ * @brief Detach a whole slot list.
+ */
+static os_wtimer_t* twheel_take_slot(os_twheel_t w, unsigned level, unsigned idx) {
+    os_wtimer_t* list = w->slot[level][idx];
+    w->slot[level][idx] = NULL;
+    w->occupied[level] &= ~(1ULL << idx);
+    return list; // Every timer is relinked (or expired) by the caller
+}
+
+
+/**
+ * @brief Next tick that needs processing (a due level-0 slot or a cascade).
+ *
+ * Only meaningful while the wheel holds timers.
+ */
+static uint64_t twheel_next_tick(os_twheel_t w) {
+    uint64_t t = w->tick;
+    unsigned idx = (unsigned)t & TW_MASK;
+    bool upper = false;
+    for (unsigned l = 1; l < TW_LEVELS; l++) upper |= (w->occupied[l] != 0);
+
+    if (idx == 0 && upper) return t; // Cascade due
+    uint64_t ahead = w->occupied[0] >> idx;
+    if (ahead) return t + (uint64_t)__builtin_ctzll(ahead);
+
+    uint64_t boundary = (t | TW_MASK) + 1;
+    if (upper) return boundary;
+    return boundary + (uint64_t)__builtin_ctzll(w->occupied[0]); // Next lap of level 0
+}
+
+
+/**
+ * @brief Process tick @p tick: cascade upper levels, move due timers to the expired list.
+ */
+static void twheel_process_tick(os_twheel_t w, uint64_t tick) {
+    w->tick = tick;
+
+    if ((tick & TW_MASK) == 0) {
+        for (unsigned l = 1; l < TW_LEVELS; l++) {
+            unsigned idx = (unsigned)(tick >> (TW_BITS * l)) & TW_MASK;
+            for (os_wtimer_t* t = twheel_take_slot(w, l, idx), *next; t; t = next) {
+                next = t->next;
+                twheel_insert(w, t);
+            }
+            if (idx != 0) break; // Higher levels only cascade when this one wraps
+        }
+    }
+
+    for (os_wtimer_t* t = twheel_take_slot(w, 0, (unsigned)tick & TW_MASK), *next; t; t = next) {
+        next = t->next;
+        if (t->expires > tick) { twheel_insert(w, t); continue; } // Clamped far timer
+        w->count--;
+        t->level = TW_EXPIRED;
+        twheel_link(&w->expired, t);
+    }
+
+    w->tick = tick + 1;
+}
+
+
+/**
+ * @brief Arm the timerfd for the next tick with work, if it changed.
+ */
+static void twheel_rearm(os_twheel_t w) {
+    uint64_t next = w->count ? twheel_next_tick(w) : 0;
+    if (next == w->armed) return;
+    w->armed = next;
+    os_timer_arm(w->timer, next * w->tick_ms);
+}
+
+
+/**
+ * @brief Current tick.
+ */
+static uint64_t twheel_now(os_twheel_t w) {
+    return os_time_ms() / w->tick_ms;
+}
+
+
+/**
+ * @brief Create a hierarchical timer wheel (Linux implementation).
+ */
+os_twheel_t os_twheel_create(uint32_t tick_ms) {
+    struct os_twheel* w = mem_alloc(sizeof(*w));
+    if (!w) return NULL;
+
+    w->timer = os_timer_create();
+    if (!w->timer) { mem_free(w); return NULL; }
+
+    w->tick_ms = tick_ms ? tick_ms : 1;
+    w->tick = twheel_now(w);
+    pthread_mutex_init(&w->m, NULL);
+    pthread_cond_init(&w->idle, NULL);
+    return w;
+}
+
+
+/**
+ * @brief Name a timer wheel and include its lock in os_mutex_list_stats() (Linux implementation).
+ */
+void os_twheel_set_name(os_twheel_t w, const char* name) {
+    if (w && name) lock_stats_set_name(&w->lock, name);
+}
+
+
+/**
+ * @brief Descriptor that becomes readable when timers are due (Linux implementation).
+ */
+int os_twheel_fd(os_twheel_t w) {
+    return w ? os_timer_fd(w->timer) : -1;
+}
+
+
+/**
+ * @brief Run the callbacks of all due timers (Linux implementation).
+ */
+void os_twheel_dispatch(os_twheel_t w) {
+    if (!w) return;
+
+    os_timer_ack(w->timer);
+    lock_take(&w->m, &w->lock);
+
+    uint64_t now = twheel_now(w);
+    while (w->count) {
+        uint64_t next = twheel_next_tick(w);
+        if (next > now) break;
+        twheel_process_tick(w, next);
+    }
+    if (w->tick <= now) w->tick = now + 1; // Nothing is due in the skipped ticks
+
+    // One callback at a time, unlocked; cancel() may still pull pending ones
+    os_wtimer_t* t;
+    while ((t = w->expired) != NULL) {
+        twheel_unlink(t);
+        w->running = t;
+        w->runner = pthread_self();
+        lock_drop(&w->m, &w->lock);
+
+        t->fn(t->arg);
+
+        lock_take(&w->m, &w->lock);
+        w->running = NULL;
+        pthread_cond_broadcast(&w->idle);
+    }
+
+    w->armed = 0; // The ack consumed the expiration
+    twheel_rearm(w);
+    lock_drop(&w->m, &w->lock);
+}
+
+
+/**
+ * @brief Drive the wheel from the calling thread (Linux implementation).
+ */
+void os_twheel_run(os_twheel_t w) {
+    if (!w) return;
+
+    struct pollfd pfd = { .fd = os_timer_fd(w->timer), .events = POLLIN };
+    for (;;) {
+        if (poll(&pfd, 1, -1) > 0) os_twheel_dispatch(w);
+    }
+}
+
+
+/**
+ * @brief Prepare a timer before its first use (Linux implementation).
+ */
+void os_wtimer_init(os_wtimer_t* t, os_wtimer_fn fn, void* arg) {
+    if (!t) return;
+    memset(t, 0, sizeof(*t));
+    t->fn = fn;
+    t->arg = arg;
+}
+
+
+/**
+ * @brief Start a timer, or move it if already pending (Linux implementation).
+ */
+void os_wtimer_start(os_twheel_t w, os_wtimer_t* t, uint64_t deadline_ms) {
+    if (!w || !t || !t->fn) return;
+
+    lock_take(&w->m, &w->lock);
+    if (t->pprev) {
+        if (t->level == TW_EXPIRED) twheel_unlink(t);
+        else twheel_remove(w, t);
+    }
+
+    if (!w->count) { // Idle wheel: restart from now
+        uint64_t now = twheel_now(w);
+        if (now > w->tick) w->tick = now;
+    }
+    t->expires = (deadline_ms + w->tick_ms - 1) / w->tick_ms; // Round up: never early
+    twheel_insert(w, t);
+    w->count++;
+
+    // Only touch the timerfd when this timer needs an earlier wakeup
+    uint64_t next = twheel_next_tick(w);
+    if (!w->armed || next < w->armed) {
+        w->armed = next;
+        os_timer_arm(w->timer, next * w->tick_ms);
+    }
+    lock_drop(&w->m, &w->lock);
+}
+
+
+/**
+ * @brief Cancel a timer (Linux implementation).
+ */
+bool os_wtimer_cancel(os_twheel_t w, os_wtimer_t* t) {
+    if (!w || !t) return false;
+
+    lock_take(&w->m, &w->lock);
+    bool pending = (t->pprev != NULL);
+    if (pending) {
+        if (t->level == TW_EXPIRED) twheel_unlink(t);
+        else twheel_remove(w, t);
+    } else {
+        // Wait for a running callback, unless it is the one cancelling
+        while (w->running == t && !pthread_equal(w->runner, pthread_self()))
+            lock_wait(&w->idle, &w->m, &w->lock, NULL);
+    }
+    lock_drop(&w->m, &w->lock);
+    return pending;
+}
+
+
+/* ---------- Memory Arena ---------- */
+
+/** Huge page size assumed when rounding MAP_HUGETLB mappings */
+#define OS_HUGE_PAGE (2u * 1024 * 1024)
+
+
+/**
+ * @brief Arena bytes needed by one OSAL object (Linux implementation).
+ */
+size_t os_arena_footprint(os_obj_t kind, size_t length, size_t item_size) {
+    switch (kind) {
+    case OS_OBJ_THREAD: return cache_round(sizeof(struct os_thread));
+    case OS_OBJ_SEM:    return cache_round(sizeof(struct os_sem));
+    case OS_OBJ_MUTEX:  return cache_round(sizeof(struct os_mutex));
+    case OS_OBJ_POLLER: return cache_round(sizeof(struct os_poller));
+    case OS_OBJ_TIMER:  return cache_round(sizeof(struct os_timer));
+    case OS_OBJ_EVENT:  return cache_round(sizeof(struct os_event));
+    case OS_OBJ_TWHEEL: return cache_round(sizeof(struct os_twheel)) + cache_round(sizeof(struct os_timer));
+    case OS_OBJ_QUEUE: {
+        // Worst case over all flavours: power-of-two capacity, MPMC cells
+        size_t cap = 1;
+        while (cap < length) cap <<= 1;
+        size_t stride = (sizeof(atomic_size_t) + item_size + alignof(atomic_size_t) - 1) &
+                        ~(alignof(atomic_size_t) - 1);
+        size_t stamps = RPC_QUEUE_STATS ? cache_round(cap * sizeof(uint64_t)) : 0;
+        return cache_round(sizeof(struct os_queue)) + cache_round(cap * stride) + stamps;
+    }
+    case OS_OBJ_RING: {
+        size_t cap = 1;
+        while (cap < length) cap <<= 1;
+        return cache_round(sizeof(struct os_queue)) + cache_round(cap);
+    }
+    case OS_OBJ_MEM: return cache_round(length ? length : 1);
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Set up the object arena (Linux implementation).
+ *
+ * The region is mapped anonymously (with MAP_HUGETLB if requested and
+ * available, transparent huge pages otherwise) and every page is written
+ * once, so no page fault is left for the hot path.
+ */
+bool os_arena_init(size_t size, uint32_t flags) {
+    if (s_arena || size == 0) return false;
+
+    size = cache_round(size);
+    void* p = MAP_FAILED;
+
+    if (flags & OS_ARENA_HUGEPAGES) {
+        size_t huge = (size + OS_HUGE_PAGE - 1) & ~(size_t)(OS_HUGE_PAGE - 1);
+        p = mmap(NULL, huge, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (p != MAP_FAILED) {
+            size = huge;
+        } else {
+            RPC_LOG_INFO("No huge pages for the OSAL arena, using regular pages");
+        }
+    }
+
+    if (p == MAP_FAILED) {
+        p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (p == MAP_FAILED) return false;
+        if (flags & OS_ARENA_HUGEPAGES) madvise(p, size, MADV_HUGEPAGE);
+    }
+
+    // Prefault: write every page so none is still backed by the shared zero page
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < size; off += (size_t)page) ((volatile uint8_t*)p)[off] = 0;
+
+    s_arena_size = size;
+    s_arena_flags = flags;
+    atomic_store(&s_arena_top, 0);
+    s_arena = p;
+    return true;
+}
+
+
+/**
+ * @brief End of initialization (Linux implementation).
+ *
+ * With OS_ARENA_MLOCK all mapped memory, thread stacks included, is locked
+ * and prefaulted by mlockall(); later mappings are locked as they appear.
+ */
+void os_arena_seal(void) {
+    atomic_store(&s_sealed, true);
+
+    if ((s_arena_flags & OS_ARENA_MLOCK) && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        RPC_LOG_INFO("mlockall failed (errno %d), memory stays pageable", errno);
+    }
+}
+
+
+/**
+ * @brief Allocate a zeroed, cache-line aligned block (Linux implementation).
+ */
+void* os_mem_alloc(size_t size) {
+    return mem_alloc(size);
+}
+
+
+/**
+ * @brief Release a block from os_mem_alloc() (Linux implementation).
+ */
+void os_mem_free(void* p) {
+    mem_free(p);
+}
+
+
+/**
+ * @brief Arena bytes in use (Linux implementation).
+ */
+size_t os_arena_used(void) {
+    return s_arena ? atomic_load(&s_arena_top) : 0;
+}
+
+
+/* ---------- Misc ---------- */
+
+/**
+ * @brief Delay execution (Linux implementation).
+ */
+void os_delay_ms(uint32_t ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+
+/**
+ * @brief Monotonic time in milliseconds (Linux implementation).
+ */
+uint64_t os_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+
+/**
+ * @brief Monotonic time in nanoseconds (Linux implementation).
+ */
+uint64_t os_time_ns(void) {
+    return mono_ns();
 }
@@ -82,6 +82,19 @@ int rpc_phy_receive(uint8_t *data, size_t len) {
 }
 
 
+/**
+ * @brief Get the pollable receive descriptor.
+ *
+ * read() on a FIFO returns whatever is pending, so the receive FIFO
+ * can be polled directly.
+ *
+ * @return Descriptor of the receive FIFO.
+ */
+int rpc_phy_get_rx_fd(void) {
+	return fd_fifo_second;
+}
+
+
 /**
  * @brief Deinitialize the PHY layer.
  *